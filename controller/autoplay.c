@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "tick.h"
+#include "regbus.h"
+#include "shadow_regs.h"
+#include "realtime.h"
+#include "workq.h"
+#include "dino_frame.h"
+#include "../sim/dino_play.h"
+#include "../sim/dino_snap.h"
+
+// gcc -O2 -o dino_autoplay autoplay.c workq.c tick.c regbus.c shadow_regs.c realtime.c ../sim/dino_sim.c -lm -pthread
+
+/*
+ * Plays the board by itself, for soak testing.
+ *
+ * A copy of the game (sim/dino_sim) follows the board.  It gets the same
+ * DINO_X/DINO_Y writes every physics step, but nothing reads the game
+ * back, so it only matches a board that is where dino_sim_init() starts:
+ * freshly reset (lfsr 0x2B, obstacles at their power-on places), with the
+ * program started straight after.  Replay doesn't reload the lfsr, so a
+ * board left over from an earlier game can't be caught up with.
+ *
+ * A frame's physics steps stand for the board's time from that frame's
+ * register writes to the next frame's.  So a game over in the copy's
+ * steps has happened on the board by the next frame, which writes
+ * REPLAY=1 with the dino back at the start and nothing else; the board
+ * restarts one clock after that write, and the copy replays at the
+ * frame's first physics step, the same moment (REPLAY_LAG_FRAMES = 0
+ * frames after raising it).  The frame after that lowers REPLAY, which
+ * the board ignores outside a game over.  The very first frame also
+ * writes REPLAY=1, in case the board sits at a game over; the copy can't
+ * follow that board, but it gets it playing.
+ *
+ * Each step the copy is forked and the plans "jump at step i*8 of the next H"
+ * and "don't jump" are played out on all cores; the dino jumps now only
+ * if jumping now survives longer than anything else.  Obstacles only
+ * move once per motion period (8 physics steps), so finer jump times
+ * don't buy anything.  Ducking only changes the sprite in vga_ball.sv,
+ * so it plays the same as doing nothing and isn't searched.
+ *
+ * The jump is long (up to 1012 steps, 5 s up and down) and moves the
+ * dino 23 px forward, so the horizon defaults to a jump plus a motion
+ * period, and every jump plan is played through its landing even past
+ * the horizon.  A plan that lands scores the horizon; one that crashes
+ * past it scores just under, so it loses to not jumping.
+ *
+ * The search has to be done before the step's deadline; when it isn't,
+ * the plans that did finish decide and the step counts as a miss.
+ * Search times are CLOCK_MONOTONIC.  Under virtual time (--bus=sim) the
+ * deadline is off, so a co-simulated game plays the same on any host.
+ *
+ * Each game is also played out without jumping from where it started,
+ * and the report puts the scores next to that baseline.
+ */
+
+#define REPLAY_LAG_FRAMES  0          // REPLAY=1 frame to the copy's replay
+
+#define PLAN_STRIDE        DINO_PLAY_SUBSTEPS
+#define MAX_HORIZON        4000       // physics steps
+#define MAX_PLANS          (MAX_HORIZON / PLAN_STRIDE + 1)
+
+// The no-jump line is played first, on its own; plan i starts from its
+// snapshot at step i*PLAN_STRIDE.
+struct search {
+    struct dino_snapshot start[MAX_PLANS];
+    unsigned phase[MAX_PLANS];        // start's place in the motion period
+    unsigned horizon;
+    int      never;                   // steps the no-jump line survives
+    uint64_t deadline_ns;
+    int      survived[MAX_PLANS];     // steps before a crash, -1 = cut off
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int sig) { (void)sig; running = 0; }
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Steps from a jump to the landing, the longest over where the gravity
+// timer can be.
+static unsigned jump_steps(void)
+{
+    unsigned longest = 0;
+
+    for (int t = 0; t < GRAVITY_DELAY; ++t) {
+        struct dino d = { .y_fixed = GROUND_Y_FIXED, .gravity_timer = t };
+        unsigned n = 0;
+        do
+            physics_step(&d, n++ == 0);
+        while (d.y_fixed != GROUND_Y_FIXED);
+        if (n > longest)
+            longest = n;
+    }
+    return longest;
+}
+
+// The score the game makes from here if the dino never jumps.
+static unsigned no_jump_score(const struct dino_state *game, const struct dino *dino,
+                              unsigned phase)
+{
+    struct dino_state s = *game;
+    struct dino d = *dino;
+
+    while (!s.game_over)
+        dino_play_step(&s, &d, false, &phase);
+    return s.score;
+}
+
+// Returns how many plans there are to try.
+static unsigned play_line(struct search *sr, const struct dino_state *game,
+                          const struct dino *dino, unsigned phase)
+{
+    struct dino_state s = *game;
+    struct dino d = *dino;
+    unsigned plans = 0;
+
+    sr->never = (int)sr->horizon;
+    for (unsigned j = 0; j < sr->horizon; ++j) {
+        if (j % PLAN_STRIDE == 0) {
+            dino_snap_save(&sr->start[plans], &s, &d, j);
+            sr->phase[plans++] = phase;
+        }
+        dino_play_step(&s, &d, false, &phase);
+        if (s.game_over) {
+            sr->never = (int)j;
+            break;
+        }
+    }
+    return plans;
+}
+
+static void play_plan(void *ctx, unsigned i)
+{
+    struct search *sr = ctx;
+    struct dino_state s;
+    struct dino d;
+    unsigned phase = sr->phase[i];
+    unsigned j = (unsigned)sr->start[i].tag;
+
+    dino_snap_restore(&sr->start[i], &s, &d);
+    for (bool jump = true; j < sr->horizon || d.y_fixed != GROUND_Y_FIXED;
+         ++j, jump = false) {
+        if ((j & 7) == 0 && mono_ns() > sr->deadline_ns) {
+            sr->survived[i] = -1;
+            return;
+        }
+        dino_play_step(&s, &d, jump, &phase);
+        if (s.game_over) {
+            sr->survived[i] = j < sr->horizon ? (int)j : (int)sr->horizon - 1;
+            return;
+        }
+    }
+    sr->survived[i] = (int)sr->horizon;
+}
+
+// Jump now?  Not jumping wins ties, then the latest plan, so the jump
+// waits for its last good moment.
+static bool decide(const struct search *sr, unsigned plans)
+{
+    int best = sr->never;
+    unsigned pick = plans;
+
+    for (unsigned i = plans; i-- > 0; )
+        if (sr->survived[i] > best) {
+            best = sr->survived[i];
+            pick = i;
+        }
+    return pick == 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--bus=devmem|shm:<path>|model] [--realtime] [--threads=N]\n"
+            "          [--horizon-ms=MS] [--budget-us=US] [--ticks=N]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *bus_spec = NULL;
+    unsigned threads = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned horizon_ms = 0, budget_us = 4000;
+    uint64_t max_ticks = 0;
+    struct rt_config rt;
+    int r;
+
+    rt_defaults(&rt);
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--bus=", 6) == 0) {
+            bus_spec = argv[i] + 6;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            rt.enabled = true;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = strtoul(argv[i] + 10, NULL, 0);
+        } else if (strncmp(argv[i], "--horizon-ms=", 13) == 0) {
+            horizon_ms = strtoul(argv[i] + 13, NULL, 0);
+        } else if (strncmp(argv[i], "--budget-us=", 12) == 0) {
+            budget_us = strtoul(argv[i] + 12, NULL, 0);
+        } else if (strncmp(argv[i], "--ticks=", 8) == 0) {
+            max_ticks = strtoull(argv[i] + 8, NULL, 0);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    unsigned jump = jump_steps();
+    unsigned horizon = horizon_ms ? horizon_ms * PHYSICS_HZ / 1000 : jump + PLAN_STRIDE;
+    if (horizon < 1) horizon = 1;
+    if (horizon > MAX_HORIZON) horizon = MAX_HORIZON;
+    if (horizon < jump + PLAN_STRIDE)
+        fprintf(stderr, "autoplay: a %u-step horizon is shorter than a jump (%u steps) "
+                        "and a motion period\n", horizon, jump);
+
+    struct regbus *bus = regbus_open(bus_spec);
+    if (!bus) return 1;
+
+    struct shadow_regs regs;
+    shadow_init(&regs, bus);
+
+    // Search workers take the cores; in realtime mode they sit just
+    // below the physics thread.
+    struct workq pool;
+    r = rt.enabled ? workq_init(&pool, threads, 0, rt.physics_prio - 1)
+                   : workq_init(&pool, threads, -1, 0);
+    if (r != 0) {
+        fprintf(stderr, "search threads: %s\n", strerror(r));
+        regbus_close(bus);
+        return 1;
+    }
+
+    if (rt.enabled) {
+        if (rt_lock_memory() < 0)
+            fprintf(stderr, "realtime: running without locked memory\n");
+        if ((r = rt_setup_thread(rt.physics_cpu, rt.physics_prio)) != 0)
+            fprintf(stderr, "realtime: physics thread: %s\n", strerror(r));
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    // The copy starts at power-on; the board has to be there too.
+    struct dino_state game;
+    struct dino dino = { .x = 100, .y_fixed = GROUND_Y_FIXED };
+    unsigned phase = 0;
+    unsigned replay_in = 0;           // frames until the copy replays
+    bool replaying = false, replay = true;
+
+    dino_sim_init(&game);
+    fprintf(stderr, "autoplay: the board must be freshly reset; the copy of the game "
+                    "starts from power-on and can't see the board\n");
+
+    static struct search sr;
+    struct tick_sched sched;
+    uint64_t searches = 0, misses = 0, search_ns = 0, worst_ns = 0;
+    uint64_t games = 0, best_score = 0, score_sum = 0, baseline_sum = 0;
+    unsigned baseline = no_jump_score(&game, &dino, phase);
+
+    sr.horizon = horizon;
+    tick_init(&sched, PHYSICS_HZ, TICK_CATCH_UP);
+
+    while (running && (!max_ticks || sched.ticks < max_ticks)) {
+        unsigned steps = tick_wait(&sched);
+        bool jumped = false;
+
+        if (replay && game.game_over) {
+            // REPLAY=1 in a frame of its own, the dino at the start
+            dino = (struct dino){ .x = 100, .y_fixed = GROUND_Y_FIXED };
+            replay_in = REPLAY_LAG_FRAMES;
+            replaying = true;
+        }
+        if (replaying && replay_in-- == 0) {
+            dino_play_replay(&game, &dino);
+            phase = 0;
+            replaying = false;
+            baseline = no_jump_score(&game, &dino, phase);
+        }
+        if (replaying)
+            steps = 0;                // the board restarts without us
+
+        while (steps--) {
+            bool want_jump = false;
+
+            // Up in the air there's nothing to decide.
+            if (dino.y_fixed == GROUND_Y_FIXED) {
+                uint64_t t0 = mono_ns();
+
+                sr.deadline_ns = tick_is_virtual() ? UINT64_MAX
+                                                   : t0 + (uint64_t)budget_us * 1000;
+                unsigned plans = play_line(&sr, &game, &dino, phase);
+                workq_run(&pool, plans, play_plan, &sr);
+                want_jump = decide(&sr, plans);
+
+                uint64_t t1 = mono_ns();
+                searches++;
+                search_ns += t1 - t0;
+                if (t1 - t0 > worst_ns) worst_ns = t1 - t0;
+                if (t1 > sr.deadline_ns)
+                    misses++;
+            }
+
+            dino_play_step(&game, &dino, want_jump, &phase);
+            jumped |= want_jump;
+
+            if (game.game_over) {
+                games++;
+                score_sum += game.score;
+                baseline_sum += baseline;
+                if (game.score > best_score)
+                    best_score = game.score;
+                break;                // frozen until next frame's REPLAY
+            }
+        }
+
+        shadow_set(&regs, DINO_X_OFFSET, (uint32_t)dino.x);
+        shadow_set(&regs, DINO_Y_OFFSET, (uint32_t)(dino.y_fixed >> FIXED_SHIFT));
+        shadow_set(&regs, DUCKING_OFFSET, 0);
+        shadow_set(&regs, JUMPING_OFFSET, jumped);
+        shadow_set(&regs, REPLAY_OFFSET, replay);
+        replay = game.game_over;
+
+        if (shadow_flush(&regs))
+            (void)regbus_read(bus, REPLAY_OFFSET);
+        regbus_frame(bus);
+    }
+
+    tick_report(&sched, stderr);
+    fprintf(stderr, "search: %llu searches over %u steps on %u threads, %llu steals\n",
+            (unsigned long long)searches, horizon, pool.threads,
+            (unsigned long long)workq_steals(&pool));
+    if (tick_is_virtual())
+        fprintf(stderr, "search time mean %.1f us, worst %.1f us on this host; "
+                        "no deadline under virtual time\n",
+                searches ? search_ns / 1e3 / searches : 0.0, worst_ns / 1e3);
+    else
+        fprintf(stderr, "search time mean %.1f us, worst %.1f us, budget %u us, "
+                        "%llu deadline misses (%.3f%%)\n",
+                searches ? search_ns / 1e3 / searches : 0.0, worst_ns / 1e3, budget_us,
+                (unsigned long long)misses, searches ? 100.0 * misses / searches : 0.0);
+    fprintf(stderr, "games %llu, best score %llu, mean %.1f; never jumping, mean %.1f\n",
+            (unsigned long long)games, (unsigned long long)best_score,
+            games ? (double)score_sum / games : 0.0,
+            games ? (double)baseline_sum / games : 0.0);
+    regbus_report(bus, stderr);
+
+    workq_destroy(&pool);
+    regbus_close(bus);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef DINO_FRAME_H
+#define DINO_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pad_input.h"
+#include "regbus.h"
+#include "shadow_regs.h"
+#include "tick.h"
+#include "dino_physics.h"
+
+/* vga_ball registers the controllers write, as byte offsets */
+#define DINO_X_OFFSET      (0 * 4)
+#define DINO_Y_OFFSET      (1 * 4)
+#define DUCKING_OFFSET     (13 * 4)
+#define JUMPING_OFFSET     (14 * 4)
+#define REPLAY_OFFSET      (19 * 4)
+
+// One frame of the pad-driven game, shared by dinofinals3.c and
+// dino_replay.c so a recorded session goes through the same code: folds
+// the frame's n events into held (the stick's position until the next
+// report), runs steps physics steps and pushes the registers out.
+// Returns tick_now_ns() after the first step, 0 if there was none.
+static inline uint64_t dino_frame(struct shadow_regs *regs, struct dino *dino,
+                                  struct pad_event *held,
+                                  const struct pad_event *events, int n,
+                                  unsigned steps)
+{
+    // A press and release can both land between two frames; don't lose it.
+    bool up = false, down = false, start = false;
+    for (int i = 0; i < n; ++i) {
+        up    |= events[i].jump;
+        down  |= events[i].duck;
+        start |= events[i].replay;
+    }
+    if (n > 0)
+        *held = events[n - 1];
+
+    bool jumped = false, ducked = false;
+    bool want_replay = (start || held->replay);
+
+    uint64_t t_physics = 0;
+    while (steps--) {
+        bool on_ground = (dino->y_fixed == GROUND_Y_FIXED);
+        bool want_jump = ((up || held->jump) && on_ground);
+        bool want_duck = ((down || held->duck) && on_ground);
+
+        physics_step(dino, want_jump);
+        jumped |= want_jump;
+        ducked |= want_duck;
+        up = down = false;
+        if (!t_physics)
+            t_physics = tick_now_ns();
+    }
+
+    shadow_set(regs, DINO_X_OFFSET, (uint32_t)dino->x);
+    shadow_set(regs, DINO_Y_OFFSET, (uint32_t)(dino->y_fixed >> FIXED_SHIFT));
+    shadow_set(regs, DUCKING_OFFSET, ducked);
+    shadow_set(regs, JUMPING_OFFSET, jumped);
+    shadow_set(regs, REPLAY_OFFSET, want_replay);
+
+    // Reading back from the bridge makes sure the posted writes landed.
+    if (shadow_flush(regs))
+        (void)regbus_read(regs->bus, REPLAY_OFFSET);
+    regbus_frame(regs->bus);
+    return t_physics;
+}
+
+#endif
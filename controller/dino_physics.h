@@ -0,0 +1,49 @@
+#ifndef DINO_PHYSICS_H
+#define DINO_PHYSICS_H
+
+#include <stdbool.h>
+
+/* The dino's jump, in 1/16 pixel fixed point.  Shared by the controller
+   and the simulators in sim/ so they can't drift apart. */
+
+#define GROUND_Y           248
+#define FIXED_SHIFT        4
+#define GROUND_Y_FIXED     (GROUND_Y << FIXED_SHIFT)
+
+#define INITIAL_VELOCITY   (-84)      // High jump
+#define GRAVITY            1          // Gentle gravity
+#define GRAVITY_DELAY      6          // Delay before applying gravity again
+#define JUMP_DX            23         // every jump also nudges the dino right
+#define PHYSICS_HZ         200        // Fixed step; the old loop slept 5 ms per report
+
+struct dino {
+    int x;
+    int y_fixed;
+    int v_fixed;
+    int gravity_timer;
+};
+
+// One fixed physics step.  Jump and airtime no longer depend on how
+// often the pad reports, only on PHYSICS_HZ.
+static inline void physics_step(struct dino *d, bool want_jump)
+{
+    if (want_jump) {
+        d->v_fixed = INITIAL_VELOCITY;
+        d->x += JUMP_DX;
+    }
+
+    // Apply gravity only every GRAVITY_DELAY frames
+    if (++d->gravity_timer >= GRAVITY_DELAY) {
+        d->v_fixed += GRAVITY;
+        d->gravity_timer = 0;
+    }
+
+    d->y_fixed += d->v_fixed;
+
+    if (d->y_fixed > GROUND_Y_FIXED) {
+        d->y_fixed = GROUND_Y_FIXED;
+        d->v_fixed = 0;
+    }
+}
+
+#endif
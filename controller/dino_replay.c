@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <string.h>
+#include "tick.h"
+#include "regbus.h"
+#include "shadow_regs.h"
+#include "input_log.h"
+#include "dino_frame.h"
+
+// gcc -O2 -o dino_replay dino_replay.c input_log.c tick.c regbus.c shadow_regs.c spsc_ring.c -pthread
+// against the game model (--bus=sim), add: -DDINO_COSIM regbus_sim.c ../sim/dino_sim.c
+
+/*
+ * Plays a session recorded with dinofinals3 --record=<log> back into a
+ * register bus: frame by frame, the same events and physics steps, put
+ * through the same dino_frame() as dinofinals3.c, so the board (or the
+ * model behind --bus=sim) sees the same register writes in the same
+ * frames.
+ *
+ * By default frames go out at PHYSICS_HZ like the live game; --fast
+ * sends them back to back.  --bus=sim always runs on virtual time, i.e.
+ * as fast as possible and with the log's timing exact.  --dump prints
+ * the log instead.
+ */
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int sig) { (void)sig; running = 0; }
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s <log> [--bus=devmem|shm:<path>|model|sim[:opts]] [--fast] [--dump]\n",
+            argv0);
+}
+
+static int dump(struct input_log_reader *log)
+{
+    struct pad_event events[PAD_QUEUE_LEN];
+    unsigned steps;
+    uint64_t frame = 0, ticks = 0;
+    int n;
+
+    printf("# %u Hz; frame tick: events\n", log->physics_hz);
+    while ((n = input_log_next(log, events, PAD_QUEUE_LEN, &steps)) >= 0) {
+        if (n || steps != 1) {
+            printf("%llu %llu +%u:", (unsigned long long)frame,
+                   (unsigned long long)ticks, steps);
+            for (int i = 0; i < n; ++i)
+                printf(" %.3f %s%s%s%s", events[i].t_ns / 1e9,
+                       events[i].jump ? "jump" : "", events[i].duck ? "duck" : "",
+                       events[i].replay ? "+replay" : "",
+                       events[i].jump || events[i].duck || events[i].replay ? "" : "none");
+            printf("\n");
+        }
+        frame++;
+        ticks += steps;
+    }
+    printf("# %llu frames, %llu ticks\n", (unsigned long long)frame, (unsigned long long)ticks);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL, *bus_spec = NULL;
+    bool fast = false, dump_only = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--bus=", 6) == 0) {
+            bus_spec = argv[i] + 6;
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            fast = true;
+        } else if (strcmp(argv[i], "--dump") == 0) {
+            dump_only = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct input_log_reader log;
+    if (input_log_read(&log, path) < 0)
+        return 1;
+    if (dump_only) {
+        dump(&log);
+        input_log_reader_free(&log);
+        return 0;
+    }
+    if (log.physics_hz != PHYSICS_HZ)
+        fprintf(stderr, "%s was recorded at %u Hz, playing at %u Hz\n",
+                path, log.physics_hz, PHYSICS_HZ);
+
+    struct regbus *bus = regbus_open(bus_spec);
+    if (!bus) {
+        input_log_reader_free(&log);
+        return 1;
+    }
+
+    struct shadow_regs regs;
+    shadow_init(&regs, bus);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    // dinofinals3.c's loop, with the log in place of the pad and the
+    // scheduler.
+    struct dino dino = { .x = 100, .y_fixed = GROUND_Y_FIXED };
+    struct pad_event held = { .y_axis = 0x7F };
+    struct pad_event events[PAD_QUEUE_LEN];
+    struct tick_sched sched;
+    uint64_t frames = 0, events_played = 0;
+    unsigned steps;
+    int n;
+
+    tick_init(&sched, PHYSICS_HZ, TICK_CATCH_UP);
+
+    while (running && (n = input_log_next(&log, events, PAD_QUEUE_LEN, &steps)) >= 0) {
+        // A frame that caught up on k steps came k periods after the last.
+        if (!fast || tick_is_virtual())
+            for (unsigned k = 0; k < steps; ++k)
+                (void)tick_wait(&sched);
+
+        dino_frame(&regs, &dino, &held, events, n, steps);
+
+        frames++;
+        events_played += n;
+    }
+
+    fprintf(stderr, "replay: %llu frames, %llu events from %s%s\n",
+            (unsigned long long)frames, (unsigned long long)events_played, path,
+            running ? "" : " (stopped)");
+    tick_report(&sched, stderr);
+    regbus_report(bus, stderr);
+
+    input_log_reader_free(&log);
+    regbus_close(bus);
+    return 0;
+}
@@ -3,102 +3,204 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <fcntl.h>
-#include <sys/mman.h>
+#include <signal.h>
+#include <string.h>
 #include <libusb-1.0/libusb.h>
 #include "usbkeyboard.h"
+#include "pad_input.h"
+#include "tick.h"
+#include "latency.h"
+#include "regbus.h"
+#include "shadow_regs.h"
+#include "realtime.h"
+#include "input_log.h"
+#include "dino_frame.h"
+
+// gcc -o dino_jump8 dinofinals3.c usbkeyboard.c pad_input.c tick.c latency.c regbus.c shadow_regs.c realtime.c spsc_ring.c input_log.c -lusb-1.0 -lm -pthread
+// co-simulation on a PC (--bus=sim, --pad=script:<file>):
+// gcc -O2 -DDINO_COSIM -o dino_cosim dinofinals3.c usbkeyboard.c pad_input.c tick.c latency.c regbus.c regbus_sim.c shadow_regs.c realtime.c spsc_ring.c input_log.c ../sim/dino_sim.c -lusb-1.0 -lm -pthread
+
+static volatile sig_atomic_t running = 1;
+static volatile sig_atomic_t dump_latency = 0;
+
+static void on_signal(int sig) { (void)sig; running = 0; }
+static void on_usr1(int sig)   { (void)sig; dump_latency = 1; }
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--bus=devmem|shm:<path>|model|sim[:opts]] [--pad=script:<path>]\n"
+            "          [--record=<log>] [--realtime] [--isolate] [--jitter-bench=TICKS]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *bus_spec = NULL;     // --bus=devmem|shm:<path>|model|sim
+    const char *pad_script = NULL;   // --pad=script:<path> instead of the USB pad
+    const char *record = NULL;       // --record=<log>, for dino_replay
+    unsigned bench_ticks = 0;
+    struct rt_config rt;
+
+    rt_defaults(&rt);
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--bus=", 6) == 0) {
+            bus_spec = argv[i] + 6;
+        } else if (strncmp(argv[i], "--pad=script:", 13) == 0) {
+            pad_script = argv[i] + 13;
+        } else if (strncmp(argv[i], "--record=", 9) == 0) {
+            record = argv[i] + 9;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            rt.enabled = true;
+        } else if (strcmp(argv[i], "--isolate") == 0) {
+            rt.isolate = true;
+        } else if (strncmp(argv[i], "--jitter-bench=", 15) == 0) {
+            bench_ticks = strtoul(argv[i] + 15, NULL, 0);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Compares tick-period spread with and without the realtime setup.
+    if (bench_ticks) {
+        rt_jitter_bench(PHYSICS_HZ, bench_ticks, &rt, stdout);
+        return 0;
+    }
+
+    struct regbus *bus = regbus_open(bus_spec);
+    if (!bus) return 1;
 
-#define REPORT_LEN         8
-#define LW_BRIDGE_BASE     0xFF200000
-#define MAP_SIZE           0x1000
-
-#define DINO_X_OFFSET      (0 * 4)
-#define DINO_Y_OFFSET      (1 * 4)
-#define DUCKING_OFFSET     (13 * 4)
-#define JUMPING_OFFSET     (14 * 4)
-#define REPLAY_OFFSET      (19 * 4)
-
-#define GROUND_Y           248
-#define FIXED_SHIFT        4
-#define GROUND_Y_FIXED     (GROUND_Y << FIXED_SHIFT)
-
-#define INITIAL_VELOCITY   (-84)      // High jump
-#define GRAVITY            1          // Gentle gravity
-#define GRAVITY_DELAY      6          // Delay before applying gravity again
-#define DELAY_US           5000
-
-int main(void) {
-    int fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (fd < 0) { perror("open(/dev/mem)"); return 1; }
-    void *lw_base = mmap(NULL, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, LW_BRIDGE_BASE);
-    if (lw_base == MAP_FAILED) { perror("mmap"); return 1; }
-
-    volatile uint32_t *dino_x_reg = (uint32_t *)(lw_base + DINO_X_OFFSET);
-    volatile uint32_t *dino_y_reg = (uint32_t *)(lw_base + DINO_Y_OFFSET);
-    volatile uint32_t *duck_reg   = (uint32_t *)(lw_base + DUCKING_OFFSET);
-    volatile uint32_t *jump_reg   = (uint32_t *)(lw_base + JUMPING_OFFSET);
-    volatile uint32_t *replay_reg = (uint32_t *)(lw_base + REPLAY_OFFSET);
-
-    struct libusb_device_handle *pad;
+    struct shadow_regs regs;
+    shadow_init(&regs, bus);
+
+    struct input_log *log = NULL;
+    if (record && !(log = input_log_open(record, PHYSICS_HZ))) {
+        regbus_close(bus);
+        return 1;
+    }
+
+    struct libusb_device_handle *pad = NULL;
+    struct pad_input *input;
     uint8_t ep;
-    pad = openkeyboard(&ep);
-    if (!pad) {
-        fprintf(stderr, "Controller not found\n");
-        munmap(lw_base, MAP_SIZE);
-        close(fd);
+    int n, r;
+
+    if (pad_script) {
+        input = pad_input_script(pad_script);
+        if (!input) {
+            input_log_close(log);
+            regbus_close(bus);
+            return 1;
+        }
+    } else {
+        pad = openkeyboard(&ep);
+        if (!pad) {
+            fprintf(stderr, "Controller not found\n");
+            input_log_close(log);
+            regbus_close(bus);
+            return 1;
+        }
+        input = pad_input_start(pad, ep);
+        if (!input) {
+            libusb_close(pad);
+            libusb_exit(NULL);
+            input_log_close(log);
+            regbus_close(bus);
+            return 1;
+        }
+    }
+
+    // USB completions get their own thread and hand events over through
+    // a lock-free ring.  In realtime mode it sits on the other core and
+    // physics runs SCHED_FIFO on this one.
+    r = rt.enabled ? pad_input_spawn(input, rt.input_cpu, rt.input_prio)
+                   : pad_input_spawn(input, -1, 0);
+    if (r != 0) {
+        fprintf(stderr, "input thread: %s\n", strerror(r));
+        pad_input_stop(input);
+        if (pad) {
+            libusb_close(pad);
+            libusb_exit(NULL);
+        }
+        input_log_close(log);
+        regbus_close(bus);
         return 1;
     }
 
-    int y_fixed = GROUND_Y_FIXED;
-    int v_fixed = 0;
-    int x = 100;
-    int gravity_timer = 0;
+    if (rt.enabled) {
+        if (rt_lock_memory() < 0)
+            fprintf(stderr, "realtime: running without locked memory\n");
+        if (rt.isolate)
+            fprintf(stderr, "realtime: moved %d IRQs off cpu %d\n",
+                    rt_isolate_cpu(rt.physics_cpu), rt.physics_cpu);
+        if ((r = rt_setup_thread(rt.physics_cpu, rt.physics_prio)) != 0)
+            fprintf(stderr, "realtime: physics thread: %s\n", strerror(r));
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGUSR1, on_usr1);   // kill -USR1 <pid> prints the latency histograms
+
+    struct dino dino = { .x = 100, .y_fixed = GROUND_Y_FIXED };
+
+    // The pad only reports on change, so the last report is the stick's
+    // current position until a new one arrives.
+    struct pad_event held = { .y_axis = 0x7F };
+    struct pad_event events[PAD_QUEUE_LEN];
+    struct tick_sched sched;
 
-    unsigned char report[REPORT_LEN];
-    int transferred, r;
+    tick_init(&sched, PHYSICS_HZ, TICK_CATCH_UP);
 
-    while (1) {
-        r = libusb_interrupt_transfer(pad, ep, report, REPORT_LEN, &transferred, 0);
+    while (running) {
+        unsigned steps = tick_wait(&sched);
+
+        r = pad_input_poll(input, 0);
         if (r < 0) {
             fprintf(stderr, "USB read error: %d\n", r);
             break;
         }
 
-        uint8_t y_axis = report[4];
-        bool want_jump = (y_axis == 0x00 && y_fixed == GROUND_Y_FIXED);
-        bool want_duck = (y_axis == 0xFF && y_fixed == GROUND_Y_FIXED);
-        bool want_replay = (report[6] & 0x20);
-
-        if (want_jump) {
-            v_fixed = INITIAL_VELOCITY;
-            x += 23;
-        }
-
-        // Apply gravity only every GRAVITY_DELAY frames
-        if (++gravity_timer >= GRAVITY_DELAY) {
-            v_fixed += GRAVITY;
-            gravity_timer = 0;
+        n = pad_input_drain(input, events, PAD_QUEUE_LEN);
+        if (log) {
+            for (int i = 0; i < n; ++i)
+                input_log_event(log, &events[i]);
+            input_log_frame(log, steps);
         }
 
-        y_fixed += v_fixed;
+        uint64_t t_physics = dino_frame(&regs, &dino, &held, events, n, steps);
+        uint64_t t_written = tick_now_ns();
 
-        if (y_fixed > GROUND_Y_FIXED) {
-            y_fixed = GROUND_Y_FIXED;
-            v_fixed = 0;
+        for (int i = 0; i < n; ++i) {
+            lat_record(LAT_QUEUE, t_physics - events[i].t_decoded);
+            lat_record(LAT_TOTAL, t_written - events[i].t_ns);
         }
+        if (n > 0)
+            lat_record(LAT_MMIO, t_written - t_physics);
 
-        *dino_x_reg = (uint32_t)x;
-        *dino_y_reg = (uint32_t)(y_fixed >> FIXED_SHIFT);
-        *jump_reg = want_jump;
-        *duck_reg = want_duck;
-        *replay_reg = want_replay;
+        if (dump_latency) {
+            dump_latency = 0;
+            lat_dump(stderr);
+        }
+    }
 
-        usleep(DELAY_US);
+    tick_report(&sched, stderr);
+    lat_dump(stderr);
+    fprintf(stderr, "register writes %llu, saved %llu\n",
+            (unsigned long long)regs.writes,
+            (unsigned long long)shadow_saved(&regs));
+    regbus_report(bus, stderr);
+    fprintf(stderr, "input ring: %u dropped, high water %u of %d\n",
+            pad_input_dropped(input), pad_input_high_water(input), PAD_QUEUE_LEN);
+
+    if (log) {
+        fprintf(stderr, "input log: %u records dropped\n", input_log_dropped(log));
+        input_log_close(log);
     }
 
-    libusb_close(pad);
-    libusb_exit(NULL);
-    munmap(lw_base, MAP_SIZE);
-    close(fd);
+    pad_input_stop(input);
+    if (pad) {
+        libusb_close(pad);
+        libusb_exit(NULL);
+    }
+    regbus_close(bus);
     return 0;
 }
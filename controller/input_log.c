@@ -0,0 +1,283 @@
+/*  input_log.c – compact record/replay log of pad input (input_log.h)
+ *
+ *  The game loop's half is two spsc_push() calls; encoding, run-length
+ *  folding of idle frames and file I/O all happen on the writer thread.
+ *  Idle runs are cut every IDLE_RUN_MAX frames so a crash loses at most
+ *  that much of a quiet stretch, never an event.
+ */
+
+#include "input_log.h"
+#include "spsc_ring.h"
+#include "tick.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define IDLE_RUN_MAX  1000            // frames (5 s at 200 Hz)
+
+enum { REC_EVENT, REC_FRAME };
+
+struct log_rec {
+    uint64_t t_ns;
+    uint16_t steps;
+    uint8_t  kind;
+    uint8_t  flags;
+};
+
+struct input_log {
+    struct spsc_ring ring;            // game loop -> writer
+    FILE            *f;
+    pthread_t        thread;
+    volatile bool    stop;
+
+    /* writer only */
+    uint64_t         idle_run;
+    uint64_t         last_ns;         // previous event, or input_log_open()
+    bool             in_frame;        // events written, frame not closed yet
+};
+
+static void put_varint(FILE *f, uint64_t v)
+{
+    while (v >= 0x80) {
+        putc((int)(v & 0x7F) | 0x80, f);
+        v >>= 7;
+    }
+    putc((int)v, f);
+}
+
+static void end_idle_run(struct input_log *log)
+{
+    if (log->idle_run) {
+        putc(0x00, log->f);
+        put_varint(log->f, log->idle_run);
+        log->idle_run = 0;
+    }
+}
+
+static void encode(struct input_log *log, const struct log_rec *rec)
+{
+    // A frame after an event is never folded into a run: it closes the
+    // event's frame with 0x01.
+    if (rec->kind == REC_FRAME && rec->steps == 1 && !log->in_frame) {
+        if (++log->idle_run == IDLE_RUN_MAX)
+            end_idle_run(log);
+        return;
+    }
+    end_idle_run(log);
+
+    log->in_frame = rec->kind == REC_EVENT;
+    if (rec->kind == REC_FRAME) {
+        putc(0x01, log->f);
+        put_varint(log->f, rec->steps);
+    } else {
+        uint64_t dt = rec->t_ns > log->last_ns ? rec->t_ns - log->last_ns : 0;
+        putc(0x10 | rec->flags, log->f);
+        put_varint(log->f, dt / 1000);
+        log->last_ns = rec->t_ns;
+    }
+}
+
+static void *writer_thread(void *arg)
+{
+    struct input_log *log = arg;
+    struct log_rec batch[256];
+
+    for (;;) {
+        bool stop = log->stop;
+        uint32_t n;
+
+        while ((n = spsc_pop(&log->ring, batch, 256)) > 0)
+            for (uint32_t i = 0; i < n; ++i)
+                encode(log, &batch[i]);
+        fflush(log->f);
+
+        if (stop)
+            break;
+        struct timespec ts = { 0, INPUT_LOG_FLUSH_MS * 1000000L };
+        while (nanosleep(&ts, &ts) < 0 && errno == EINTR)
+            ;
+    }
+    end_idle_run(log);
+    return NULL;
+}
+
+struct input_log *input_log_open(const char *path, unsigned physics_hz)
+{
+    struct input_log *log = calloc(1, sizeof *log);
+    if (!log) return NULL;
+
+    if (spsc_init(&log->ring, INPUT_LOG_RING, sizeof(struct log_rec)) < 0) {
+        free(log);
+        return NULL;
+    }
+    if (!(log->f = fopen(path, "wb"))) {
+        perror(path);
+        spsc_free(&log->ring);
+        free(log);
+        return NULL;
+    }
+    log->last_ns = tick_now_ns();       // the first event's dt counts from here
+    fwrite(INPUT_LOG_MAGIC, 1, 8, log->f);
+    put_varint(log->f, physics_hz);
+
+    int r = pthread_create(&log->thread, NULL, writer_thread, log);
+    if (r != 0) {
+        fprintf(stderr, "input log writer: %s\n", strerror(r));
+        fclose(log->f);
+        spsc_free(&log->ring);
+        free(log);
+        return NULL;
+    }
+    return log;
+}
+
+static void push(struct input_log *log, const struct log_rec *rec)
+{
+    // On virtual time the loop outruns the writer by far and nothing is
+    // real time anyway: wait for room rather than drop.
+    if (tick_is_virtual())
+        while (spsc_full(&log->ring))
+            sched_yield();
+    spsc_push(&log->ring, rec);
+}
+
+void input_log_event(struct input_log *log, const struct pad_event *ev)
+{
+    struct log_rec rec = {
+        .t_ns  = ev->t_ns,
+        .kind  = REC_EVENT,
+        .flags = (ev->jump ? 1 : 0) | (ev->duck ? 2 : 0) | (ev->replay ? 4 : 0),
+    };
+    push(log, &rec);
+}
+
+void input_log_frame(struct input_log *log, unsigned steps)
+{
+    struct log_rec rec = {
+        .steps = (uint16_t)steps,
+        .kind  = REC_FRAME,
+    };
+    push(log, &rec);
+}
+
+void input_log_close(struct input_log *log)
+{
+    if (!log) return;
+
+    log->stop = true;
+    pthread_join(log->thread, NULL);
+    fclose(log->f);
+    spsc_free(&log->ring);
+    free(log);
+}
+
+uint32_t input_log_dropped(const struct input_log *log)
+{
+    return spsc_dropped(&log->ring);
+}
+
+/* ------------------------------------------------------------------ */
+static int get_varint(struct input_log_reader *r, uint64_t *v)
+{
+    *v = 0;
+    for (unsigned shift = 0; r->pos < r->len && shift < 64; shift += 7) {
+        uint8_t b = r->buf[r->pos++];
+        *v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return 0;
+    }
+    return -1;
+}
+
+int input_log_read(struct input_log_reader *r, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    uint64_t hz;
+
+    memset(r, 0, sizeof *r);
+    if (!f) { perror(path); return -1; }
+
+    size_t cap = 1 << 16;
+    r->buf = malloc(cap);
+    while (r->buf) {
+        r->len += fread(r->buf + r->len, 1, cap - r->len, f);
+        if (r->len < cap)
+            break;
+        uint8_t *b = realloc(r->buf, cap *= 2);
+        if (!b) { free(r->buf); r->buf = NULL; }
+        else r->buf = b;
+    }
+    fclose(f);
+
+    if (!r->buf) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        return -1;
+    }
+    if (r->len < 8 || memcmp(r->buf, INPUT_LOG_MAGIC, 8) != 0) {
+        fprintf(stderr, "%s: not an input log\n", path);
+        input_log_reader_free(r);
+        return -1;
+    }
+    r->pos = 8;
+    if (get_varint(r, &hz) < 0 || hz == 0) {
+        fprintf(stderr, "%s: bad header\n", path);
+        input_log_reader_free(r);
+        return -1;
+    }
+    r->physics_hz = (unsigned)hz;
+    return 0;
+}
+
+void input_log_reader_free(struct input_log_reader *r)
+{
+    free(r->buf);
+    r->buf = NULL;
+}
+
+int input_log_next(struct input_log_reader *r, struct pad_event *ev, int max,
+                   unsigned *steps)
+{
+    int n = 0;
+
+    if (r->idle_left) {
+        r->idle_left--;
+        *steps = 1;
+        return 0;
+    }
+
+    while (r->pos < r->len) {
+        uint8_t tag = r->buf[r->pos++];
+        uint64_t v;
+
+        if (get_varint(r, &v) < 0)
+            break;
+        if (tag == 0x00 && n == 0 && v > 0) {
+            r->idle_left = v - 1;
+            *steps = 1;
+            return 0;
+        } else if (tag == 0x01) {
+            *steps = (unsigned)v;
+            return n;
+        } else if ((tag & 0xF8) == 0x10) {
+            r->t_ns += v * 1000;
+            if (n < max) {
+                memset(&ev[n], 0, sizeof ev[n]);
+                ev[n].t_ns    = ev[n].t_decoded = r->t_ns;
+                ev[n].jump    = tag & 1;
+                ev[n].duck    = (tag & 2) != 0;
+                ev[n].replay  = (tag & 4) != 0;
+                ev[n].y_axis  = ev[n].jump ? 0x00 : ev[n].duck ? 0xFF : 0x7F;
+                ev[n].buttons = ev[n].replay ? 0x20 : 0;
+                n++;
+            }
+        } else {
+            break;
+        }
+    }
+    if (r->pos < r->len || n > 0)
+        fprintf(stderr, "input log: damaged at byte %zu\n", r->pos);
+    return -1;
+}
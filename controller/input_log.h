@@ -0,0 +1,69 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pad_input.h"
+
+/* Append-only log of what the game loop got from the pad: every decoded
+ * event and every frame boundary with the physics steps it ran.  Played
+ * back frame by frame it reproduces a session exactly.
+ *
+ * The game loop only pushes fixed-size records into an SPSC ring; a
+ * background thread encodes them and writes the file, flushing every
+ * INPUT_LOG_FLUSH_MS.
+ *
+ * File: "DINOLOG" 0x01, varint PHYSICS_HZ, then records:
+ *
+ *   0x00 n          n frames of one step and no events
+ *   0x01 steps      end of a frame that had events or ran steps != 1
+ *   0x10|flags dt   an event; flags bit 0 jump, 1 duck, 2 replay;
+ *                   dt = microseconds since the previous event's t_ns
+ *                   (the first: since input_log_open())
+ *
+ * Varints are LEB128 (7 bits a byte, low first).  A quiet minute costs
+ * about 40 bytes; each event is 2-4 bytes.
+ */
+
+#define INPUT_LOG_MAGIC     "DINOLOG\1"
+#define INPUT_LOG_RING      4096      // records between loop and writer
+#define INPUT_LOG_FLUSH_MS  10
+
+struct input_log;
+
+/* Creates path and starts the writer thread.  NULL on failure. */
+struct input_log *input_log_open(const char *path, unsigned physics_hz);
+
+/* Game loop side: never blocks.  A full ring drops the record (counted),
+   except on virtual time (tick_virtual()), where it waits. */
+void input_log_event(struct input_log *log, const struct pad_event *ev);
+void input_log_frame(struct input_log *log, unsigned steps);
+
+/* Writes everything still queued and closes the file. */
+void input_log_close(struct input_log *log);
+
+uint32_t input_log_dropped(const struct input_log *log);
+
+/* ------------------------------------------------------------------ */
+/*  reading                                                            */
+
+struct input_log_reader {
+    uint8_t  *buf;
+    size_t    len, pos;
+    unsigned  physics_hz;
+    uint64_t  idle_left;              // rest of the current 0x00 run
+    uint64_t  t_ns;                   // event time, from dt sums
+};
+
+/* Reads the whole file.  0, or -1 with the reason on stderr. */
+int  input_log_read(struct input_log_reader *r, const char *path);
+void input_log_reader_free(struct input_log_reader *r);
+
+/* The next frame: its events (at most max, with t_ns/jump/duck/replay
+   filled in) and how many steps it ran.  Returns the event count, or
+   -1 at the end of the log (or a damaged tail, reported on stderr). */
+int  input_log_next(struct input_log_reader *r, struct pad_event *ev, int max,
+                    unsigned *steps);
+
+#endif
@@ -0,0 +1,104 @@
+/*  latency.c – lock-free log-linear latency histograms
+ *
+ *  Same idea as an HDR histogram: values below 2^SUB_BITS get their own
+ *  bucket, larger values keep their top SUB_BITS bits, so every bucket
+ *  is within ~3% of the values it holds.  Counters are bumped with
+ *  relaxed atomics so the USB callback, the physics loop and a dump
+ *  can all touch them at once.
+ */
+
+#include "latency.h"
+
+#define SUB_BITS    5
+#define SUB_COUNT   (1u << SUB_BITS)
+#define NBUCKETS    ((64 - SUB_BITS + 1) * SUB_COUNT)
+
+struct histogram {
+    uint32_t count[NBUCKETS];
+    uint64_t total;
+    uint64_t max;
+};
+
+static struct histogram hist[LAT_NSTAGES];
+
+static const char *stage_name[LAT_NSTAGES] = {
+    "decode", "queue", "mmio", "total",
+};
+
+static unsigned bucket_of(uint64_t v)
+{
+    if (v < SUB_COUNT)
+        return (unsigned)v;
+    unsigned shift = 63 - __builtin_clzll(v) - SUB_BITS;
+    return (shift + 1) * SUB_COUNT + (unsigned)((v >> shift) - SUB_COUNT);
+}
+
+/* Largest value that lands in bucket b. */
+static uint64_t bucket_top(unsigned b)
+{
+    if (b < SUB_COUNT)
+        return b;
+    unsigned shift = b / SUB_COUNT - 1;
+    uint64_t base  = (uint64_t)(b % SUB_COUNT + SUB_COUNT) << shift;
+    return base + ((1ull << shift) - 1);
+}
+
+void lat_record(enum lat_stage stage, uint64_t ns)
+{
+    struct histogram *h = &hist[stage];
+
+    __atomic_fetch_add(&h->count[bucket_of(ns)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->total, 1, __ATOMIC_RELAXED);
+
+    uint64_t old = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+    while (ns > old &&
+           !__atomic_compare_exchange_n(&h->max, &old, ns, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static uint64_t percentile(const struct histogram *h, uint64_t total, double p)
+{
+    uint64_t max  = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+    uint64_t want = (uint64_t)(p * total + 0.5), seen = 0;
+    if (want == 0) want = 1;
+
+    for (unsigned b = 0; b < NBUCKETS; ++b) {
+        seen += __atomic_load_n(&h->count[b], __ATOMIC_RELAXED);
+        if (seen >= want)
+            return bucket_top(b) < max ? bucket_top(b) : max;
+    }
+    return max;
+}
+
+void lat_dump(FILE *f)
+{
+    fprintf(f, "%-8s %10s %10s %10s %10s %10s\n",
+            "stage", "count", "p50 us", "p99 us", "p999 us", "max us");
+
+    for (int s = 0; s < LAT_NSTAGES; ++s) {
+        const struct histogram *h = &hist[s];
+        uint64_t n = __atomic_load_n(&h->total, __ATOMIC_RELAXED);
+        if (n == 0) {
+            fprintf(f, "%-8s %10d\n", stage_name[s], 0);
+            continue;
+        }
+        fprintf(f, "%-8s %10llu %10.1f %10.1f %10.1f %10.1f\n",
+                stage_name[s], (unsigned long long)n,
+                percentile(h, n, 0.50)  / 1e3,
+                percentile(h, n, 0.99)  / 1e3,
+                percentile(h, n, 0.999) / 1e3,
+                __atomic_load_n(&h->max, __ATOMIC_RELAXED) / 1e3);
+    }
+}
+
+void lat_reset(void)
+{
+    for (int s = 0; s < LAT_NSTAGES; ++s) {
+        struct histogram *h = &hist[s];
+        for (unsigned b = 0; b < NBUCKETS; ++b)
+            __atomic_store_n(&h->count[b], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&h->total, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&h->max, 0, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Input-to-screen pipeline, measured per pad report:
+     received -> decoded -> physics applied -> registers written     */
+enum lat_stage {
+    LAT_DECODE,     // transfer completed  -> report decoded
+    LAT_QUEUE,      // report decoded      -> consumed by a physics step
+    LAT_MMIO,       // physics step        -> register write finished
+    LAT_TOTAL,      // transfer completed  -> register write finished
+    LAT_NSTAGES
+};
+
+/* Adds one sample (nanoseconds).  Lock-free, safe from any thread. */
+void lat_record(enum lat_stage stage, uint64_t ns);
+
+/* Prints count/p50/p99/p999/max for every stage. */
+void lat_dump(FILE *f);
+
+void lat_reset(void);
+
+#endif
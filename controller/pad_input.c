@@ -0,0 +1,323 @@
+/*  pad_input.c – asynchronous DragonRise report pipeline on libusb 1.0
+ *
+ *  Keeps PAD_NUM_URBS interrupt transfers queued on the pad so the
+ *  kernel always has a buffer ready, even while the game loop sleeps.
+ *  Every completed report is timestamped, decoded and pushed into a
+ *  lock-free SPSC ring that the physics loop drains once per tick.
+ *  Completions run on a dedicated input thread (or, before one is
+ *  spawned, inside pad_input_poll()), so a slow USB completion never
+ *  holds up a physics tick and vice versa.
+ *
+ *  pad_input_script() feeds the same ring from a file instead, for
+ *  running the controller against the simulated board.
+ */
+
+#include "pad_input.h"
+#include "latency.h"
+#include "realtime.h"
+#include "spsc_ring.h"
+#include "tick.h"
+#include <libusb-1.0/libusb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct pad_input {
+    struct libusb_transfer *urb[PAD_NUM_URBS];
+    uint8_t                 buf[PAD_NUM_URBS][PAD_REPORT_LEN];
+    int                     in_flight;
+    volatile int            error;          /* sticky libusb error, 0 = ok */
+
+    pthread_t               thread;
+    bool                    threaded;
+    volatile bool           stop;
+    int                     cpu, prio;
+
+    struct spsc_ring        ring;           /* input thread -> physics */
+
+    /* scripted pad: raw reports and when they are due */
+    bool                    scripted;
+    uint8_t               (*script)[PAD_REPORT_LEN];
+    uint64_t               *script_ns;
+    int                     script_len, script_next;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void pad_decode(const uint8_t *report, struct pad_event *ev)
+{
+    ev->y_axis  = report[4];
+    ev->buttons = report[6];
+    ev->jump    = (report[4] == 0x00);
+    ev->duck    = (report[4] == 0xFF);
+    ev->replay  = (report[6] & 0x20) != 0;
+}
+
+/* ------------------------------------------------------------------ */
+static void on_report(struct libusb_transfer *t)
+{
+    struct pad_input *in = t->user_data;
+
+    switch (t->status) {
+    case LIBUSB_TRANSFER_COMPLETED:
+        if (t->actual_length >= PAD_REPORT_LEN) {
+            struct pad_event ev;
+            ev.t_ns = now_ns();
+            pad_decode(t->buffer, &ev);
+            ev.t_decoded = now_ns();
+            lat_record(LAT_DECODE, ev.t_decoded - ev.t_ns);
+            spsc_push(&in->ring, &ev);              /* counts a drop if full */
+        }
+        break;
+    case LIBUSB_TRANSFER_CANCELLED:
+        in->in_flight--;
+        return;
+    case LIBUSB_TRANSFER_NO_DEVICE:
+        in->error = LIBUSB_ERROR_NO_DEVICE;
+        in->in_flight--;
+        return;
+    default:                                        /* stall, timeout ... */
+        break;
+    }
+
+    /* a transfer that completed while pad_input_stop() was cancelling
+       the others isn't sent back out: stop waits for in_flight to drain */
+    if (in->stop) {
+        in->in_flight--;
+        return;
+    }
+
+    int r = libusb_submit_transfer(t);
+    if (r < 0) {
+        in->error = r;
+        in->in_flight--;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+struct pad_input *pad_input_start(struct libusb_device_handle *pad, uint8_t ep)
+{
+    struct pad_input *in = calloc(1, sizeof *in);
+    if (!in) return NULL;
+    if (spsc_init(&in->ring, PAD_QUEUE_LEN, sizeof(struct pad_event)) < 0) {
+        free(in);
+        return NULL;
+    }
+
+    for (int i = 0; i < PAD_NUM_URBS; ++i) {
+        in->urb[i] = libusb_alloc_transfer(0);
+        if (!in->urb[i])
+            break;
+        libusb_fill_interrupt_transfer(in->urb[i], pad, ep, in->buf[i],
+                                       PAD_REPORT_LEN, on_report, in, 0);
+        if (libusb_submit_transfer(in->urb[i]) == 0)
+            in->in_flight++;
+    }
+
+    if (in->in_flight == 0) {
+        fprintf(stderr, "pad_input: could not queue any transfers\n");
+        pad_input_stop(in);
+        return NULL;
+    }
+    return in;
+}
+
+/* ------------------------------------------------------------------ */
+static int script_line(const char *line, uint64_t *ms, uint8_t *report)
+{
+    char state[64];
+
+    if (sscanf(line, "%llu %63s", (unsigned long long *)ms, state) != 2)
+        return -1;
+
+    memset(report, 0, PAD_REPORT_LEN);
+    report[4] = 0x7F;
+    if (strcmp(state, "none") == 0)
+        return 0;
+    for (char *tok = strtok(state, ","); tok; tok = strtok(NULL, ",")) {
+        if (strcmp(tok, "jump") == 0)        report[4] = 0x00;
+        else if (strcmp(tok, "duck") == 0)   report[4] = 0xFF;
+        else if (strcmp(tok, "replay") == 0) report[6] |= 0x20;
+        else return -1;
+    }
+    return 0;
+}
+
+struct pad_input *pad_input_script(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return NULL; }
+
+    struct pad_input *in = calloc(1, sizeof *in);
+    if (!in || spsc_init(&in->ring, PAD_QUEUE_LEN, sizeof(struct pad_event)) < 0) {
+        free(in);
+        fclose(f);
+        return NULL;
+    }
+
+    uint64_t t0 = tick_now_ns();
+    int cap = 0, n = 0;
+
+    in->scripted = true;
+    char line[256];
+
+    while (fgets(line, sizeof line, f)) {
+        uint64_t ms;
+        uint8_t report[PAD_REPORT_LEN];
+
+        n++;
+        if (strchr(line, '#'))
+            *strchr(line, '#') = 0;
+        if (strspn(line, " \t\r\n") == strlen(line))
+            continue;
+        if (script_line(line, &ms, report) < 0) {
+            fprintf(stderr, "%s:%d: expected \"MS none|jump,duck,replay\"\n", path, n);
+            goto fail;
+        }
+        if (in->script_len == cap) {
+            cap = cap ? 2 * cap : 64;
+            void *r = realloc(in->script, cap * sizeof *in->script);
+            void *t = realloc(in->script_ns, cap * sizeof *in->script_ns);
+            if (r) in->script = r;
+            if (t) in->script_ns = t;
+            if (!r || !t)
+                goto fail;
+        }
+        memcpy(in->script[in->script_len], report, PAD_REPORT_LEN);
+        in->script_ns[in->script_len++] = t0 + ms * 1000000ull;
+    }
+    fclose(f);
+    return in;
+
+fail:
+    fclose(f);
+    free(in->script);
+    free(in->script_ns);
+    spsc_free(&in->ring);
+    free(in);
+    return NULL;
+}
+
+/* Hands over every scripted report that is due. */
+static void script_poll(struct pad_input *in)
+{
+    uint64_t now = tick_now_ns();
+
+    while (in->script_next < in->script_len && in->script_ns[in->script_next] <= now) {
+        struct pad_event ev;
+        ev.t_ns = in->script_ns[in->script_next];
+        pad_decode(in->script[in->script_next++], &ev);
+        ev.t_decoded = now;
+        spsc_push(&in->ring, &ev);
+    }
+}
+
+static void *input_thread(void *arg)
+{
+    struct pad_input *in = arg;
+
+    int r = rt_setup_thread(in->cpu, in->prio);
+    if (r)
+        fprintf(stderr, "pad_input: cpu %d prio %d: %s\n", in->cpu, in->prio, strerror(r));
+
+    while (!in->stop && in->in_flight > 0) {
+        struct timeval tv = { 0, 100000 };
+        r = libusb_handle_events_timeout_completed(NULL, &tv, NULL);
+        if (r < 0 && r != LIBUSB_ERROR_INTERRUPTED) {
+            in->error = r;
+            break;
+        }
+    }
+    return NULL;
+}
+
+int pad_input_spawn(struct pad_input *in, int cpu, int prio)
+{
+    if (in->scripted)                               /* polled from the game loop */
+        return 0;
+    in->cpu  = cpu;
+    in->prio = prio;
+    int r = pthread_create(&in->thread, NULL, input_thread, in);
+    if (r == 0)
+        in->threaded = true;
+    return r;
+}
+
+int pad_input_poll(struct pad_input *in, int timeout_us)
+{
+    if (in->scripted) {
+        script_poll(in);
+        return 0;
+    }
+    if (!in->threaded) {
+        struct timeval tv = { timeout_us / 1000000, timeout_us % 1000000 };
+        int r = libusb_handle_events_timeout_completed(NULL, &tv, NULL);
+        if (r < 0 && r != LIBUSB_ERROR_INTERRUPTED)
+            return r;
+    }
+    if (in->error)
+        return in->error;
+    return in->in_flight > 0 ? 0 : LIBUSB_ERROR_NO_DEVICE;
+}
+
+int pad_input_drain(struct pad_input *in, struct pad_event *ev, int max)
+{
+    return (int)spsc_pop(&in->ring, ev, max > 0 ? (uint32_t)max : 0);
+}
+
+uint32_t pad_input_dropped(const struct pad_input *in)
+{
+    return spsc_dropped(&in->ring);
+}
+
+uint32_t pad_input_high_water(const struct pad_input *in)
+{
+    return spsc_high_water(&in->ring);
+}
+
+void pad_input_stop(struct pad_input *in)
+{
+    if (!in) return;
+
+    in->stop = true;
+    if (in->scripted) {
+        free(in->script);
+        free(in->script_ns);
+        spsc_free(&in->ring);
+        free(in);
+        return;
+    }
+
+    if (in->threaded)
+        pthread_join(in->thread, NULL);
+
+    for (int i = 0; i < PAD_NUM_URBS; ++i)
+        if (in->urb[i])
+            libusb_cancel_transfer(in->urb[i]);
+
+    /* callbacks have to run before the transfers can be freed; if the
+       event loop fails with some still in flight, their callbacks may
+       yet fire into the URBs, the ring and *in, so leak them all */
+    while (in->in_flight > 0) {
+        struct timeval tv = { 0, 100000 };
+        int r = libusb_handle_events_timeout_completed(NULL, &tv, NULL);
+        if (r < 0 && r != LIBUSB_ERROR_INTERRUPTED) {
+            fprintf(stderr, "pad_input: %d transfer(s) still in flight at stop (libusb %d), "
+                    "leaking them\n", in->in_flight, r);
+            return;
+        }
+    }
+
+    for (int i = 0; i < PAD_NUM_URBS; ++i)
+        if (in->urb[i])
+            libusb_free_transfer(in->urb[i]);
+    spsc_free(&in->ring);
+    free(in);
+}
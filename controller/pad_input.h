@@ -0,0 +1,64 @@
+#ifndef PAD_INPUT_H
+#define PAD_INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct libusb_device_handle;        // <libusb-1.0/libusb.h>; only pad_input.c needs it
+
+#define PAD_REPORT_LEN  8
+#define PAD_NUM_URBS    4     // interrupt transfers kept in flight
+#define PAD_QUEUE_LEN   64    // decoded events waiting to be drained (power of 2)
+
+/* One decoded DragonRise report (see control.md for the byte layout). */
+struct pad_event {
+    uint64_t t_ns;       // CLOCK_MONOTONIC time the transfer completed
+    uint64_t t_decoded;  // ... and the time it was decoded
+    uint8_t  y_axis;     // report[4]: 0x00 up, 0x7f centre, 0xff down
+    uint8_t  buttons;    // report[6]
+    bool     jump;
+    bool     duck;
+    bool     replay;
+};
+
+struct pad_input;
+
+/* Submits PAD_NUM_URBS interrupt transfers on the pad's endpoint.
+   Returns NULL if none could be queued. */
+struct pad_input *pad_input_start(struct libusb_device_handle *pad, uint8_t ep);
+
+/* A scripted pad for co-simulation, no USB.  Each line of the file is
+   "MS STATE": from MS milliseconds after this call (on tick_now_ns())
+   the stick and buttons read STATE, which is "none" or a comma list of
+   jump, duck, replay.  '#' starts a comment.  Reports are decoded by
+   pad_decode() like real ones and come out of pad_input_poll() once
+   they are due.  Returns NULL if the file can't be read. */
+struct pad_input *pad_input_script(const char *path);
+
+/* Moves completion handling onto its own thread, pinned to cpu and
+   run at SCHED_FIFO prio when those are >= 0 / > 0.  Returns 0 or an
+   errno value. */
+int  pad_input_spawn(struct pad_input *in, int cpu, int prio);
+
+/* Runs libusb completions for at most timeout_us (0 = don't block);
+   once spawned it only reports status.  Returns a negative libusb
+   error once the pad is gone. */
+int  pad_input_poll(struct pad_input *in, int timeout_us);
+
+/* Copies up to max queued events, oldest first.  Returns the count. */
+int  pad_input_drain(struct pad_input *in, struct pad_event *ev, int max);
+
+/* Events thrown away because the ring was full, and the most that
+   were ever waiting at once. */
+uint32_t pad_input_dropped(const struct pad_input *in);
+uint32_t pad_input_high_water(const struct pad_input *in);
+
+/* Cancels the outstanding transfers and frees everything.  If the event
+   loop fails before every cancelled transfer has called back, those and
+   the pad_input are leaked rather than freed under a late callback. */
+void pad_input_stop(struct pad_input *in);
+
+/* Fills ev from a raw report (t_ns is left alone). */
+void pad_decode(const uint8_t *report, struct pad_event *ev);
+
+#endif
@@ -0,0 +1,310 @@
+#define _GNU_SOURCE
+#include "realtime.h"
+#include "tick.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define PREFAULT_STACK  (256 * 1024)
+#define PREFAULT_HEAP   (4 * 1024 * 1024)
+
+void rt_defaults(struct rt_config *cfg)
+{
+    cfg->enabled      = false;
+    cfg->isolate      = false;
+    cfg->physics_cpu  = 1;
+    cfg->input_cpu    = 0;
+    cfg->physics_prio = 80;
+    cfg->input_prio   = 82;
+}
+
+static void prefault_stack(void)
+{
+    volatile char stack[PREFAULT_STACK];
+    for (size_t i = 0; i < sizeof stack; i += 4096)
+        stack[i] = 0;
+}
+
+int rt_lock_memory(void)
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        perror("mlockall");
+        return -1;
+    }
+
+    // Keep freed heap mapped so later mallocs don't fault in new pages.
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    char *heap = malloc(PREFAULT_HEAP);
+    if (heap) {
+        for (size_t i = 0; i < PREFAULT_HEAP; i += 4096)
+            heap[i] = 0;
+        free(heap);
+    }
+    prefault_stack();
+    return 0;
+}
+
+int rt_setup_thread(int cpu, int prio)
+{
+    int r;
+
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        r = pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+        if (r) return r;
+    }
+    if (prio > 0) {
+        struct sched_param sp = { .sched_priority = prio };
+        r = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        if (r) return r;
+    }
+    return 0;
+}
+
+/* A cpu set as /proc/irq wants it: 32-bit hex words, highest first,
+   separated by commas. */
+static void format_mask(const cpu_set_t *set, char *buf, size_t size)
+{
+    int words = CPU_SETSIZE / 32, top = 0;
+    size_t len = 0;
+
+    for (int w = 0; w < words; w++)
+        for (int b = 0; b < 32; b++)
+            if (CPU_ISSET(32 * w + b, set))
+                top = w;
+    buf[0] = 0;
+    for (int w = top; w >= 0 && len < size; w--) {
+        unsigned bits = 0;
+        for (int b = 0; b < 32; b++)
+            if (CPU_ISSET(32 * w + b, set))
+                bits |= 1u << b;
+        len += (size_t)snprintf(buf + len, size - len, w == top ? "%x" : ",%08x", bits);
+    }
+}
+
+/* What rt_isolate_cpu() overwrote, put back by rt_restore_irqs().  The
+   restore only uses open/write/close so the signal handler can run it. */
+#define MASK_LEN (CPU_SETSIZE / 4 + CPU_SETSIZE / 32 + 2)
+
+struct saved_mask {
+    char path[64];
+    char mask[MASK_LEN];
+    int  len;
+};
+
+static struct saved_mask *saved;
+static volatile sig_atomic_t nsaved;
+
+static int save_mask(const char *path)
+{
+    struct saved_mask *s;
+    FILE *f;
+
+    if (strlen(path) >= sizeof saved->path || !(f = fopen(path, "r")))
+        return -1;
+    if (!(s = realloc(saved, (nsaved + 1) * sizeof *saved))) {
+        fclose(f);
+        return -1;
+    }
+    saved = s;
+    s += nsaved;
+    snprintf(s->path, sizeof s->path, "%s", path);
+    s->len = fgets(s->mask, sizeof s->mask, f) ? (int)strlen(s->mask) : 0;
+    fclose(f);
+    if (s->len == 0)
+        return -1;
+    nsaved++;
+    return 0;
+}
+
+void rt_restore_irqs(void)
+{
+    int n = nsaved;
+
+    nsaved = 0;
+    while (n-- > 0) {
+        int fd = open(saved[n].path, O_WRONLY);
+        if (fd < 0) continue;
+        if (write(fd, saved[n].mask, saved[n].len) < 0) {
+            // the IRQ may have gone away since; nothing to put back
+        }
+        close(fd);
+    }
+}
+
+static void restore_and_die(int sig)
+{
+    rt_restore_irqs();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/* Puts the masks back however the process ends: at exit, and on SIGINT
+   or SIGTERM unless the program already handles those itself (then its
+   handler makes it exit and the atexit hook does it). */
+static void restore_on_exit(void)
+{
+    static bool hooked;
+
+    if (hooked) return;
+    hooked = true;
+    atexit(rt_restore_irqs);
+
+    int sigs[] = { SIGINT, SIGTERM };
+    for (size_t i = 0; i < sizeof sigs / sizeof sigs[0]; i++) {
+        struct sigaction sa;
+        if (sigaction(sigs[i], NULL, &sa) == 0 && sa.sa_handler == SIG_DFL) {
+            memset(&sa, 0, sizeof sa);
+            sa.sa_handler = restore_and_die;
+            sigemptyset(&sa.sa_mask);
+            sigaction(sigs[i], &sa, NULL);
+        }
+    }
+}
+
+/* Writes mask to path, keeping what was there for rt_restore_irqs(). */
+static int steer(const char *path, const char *mask)
+{
+    if (save_mask(path) < 0)
+        return -1;
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        nsaved--;
+        return -1;
+    }
+    int ok = fprintf(f, "%s\n", mask) > 0;
+    if (fclose(f) != 0 || !ok) {     // some IRQs refuse; that's fine
+        nsaved--;
+        return -1;
+    }
+    return 0;
+}
+
+int rt_isolate_cpu(int cpu)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    char path[300], mask[MASK_LEN];
+    int moved = 0;
+
+    if (ncpu > CPU_SETSIZE)
+        ncpu = CPU_SETSIZE;
+    CPU_ZERO(&set);
+    for (long i = 0; i < ncpu; i++)
+        if (i != cpu)
+            CPU_SET(i, &set);
+    if (CPU_COUNT(&set) == 0)
+        return 0;                     // nowhere else to send them
+    format_mask(&set, mask, sizeof mask);
+
+    DIR *d = opendir("/proc/irq");
+    if (!d) return 0;
+
+    rt_restore_irqs();                // a second call starts from the originals
+    restore_on_exit();
+
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] < '0' || e->d_name[0] > '9')
+            continue;
+        snprintf(path, sizeof path, "/proc/irq/%s/smp_affinity", e->d_name);
+        if (steer(path, mask) == 0)
+            moved++;
+    }
+    closedir(d);
+
+    steer("/proc/irq/default_smp_affinity", mask);
+    return moved;
+}
+
+/* ------------------------------------------------------------------ */
+/*  jitter benchmark                                                   */
+
+struct bench {
+    unsigned hz, ticks;
+    int      cpu, prio;
+    int      setup_err;
+    double   mean_us, stddev_us, min_us, max_us;
+    uint64_t overruns;
+};
+
+static void *bench_thread(void *arg)
+{
+    struct bench *b = arg;
+    struct tick_sched t;
+    double sum = 0, sum2 = 0;
+
+    b->setup_err = rt_setup_thread(b->cpu, b->prio);
+    b->min_us = 1e30;
+    b->max_us = 0;
+
+    tick_init(&t, b->hz, TICK_SKIP);
+    tick_wait(&t);
+    uint64_t prev = tick_now_ns();
+
+    for (unsigned i = 0; i < b->ticks; ++i) {
+        tick_wait(&t);
+        uint64_t now = tick_now_ns();
+        double period = (now - prev) / 1e3;
+        prev = now;
+
+        sum  += period;
+        sum2 += period * period;
+        if (period < b->min_us) b->min_us = period;
+        if (period > b->max_us) b->max_us = period;
+    }
+
+    b->mean_us   = sum / b->ticks;
+    b->stddev_us = sqrt(sum2 / b->ticks - b->mean_us * b->mean_us);
+    b->overruns  = t.overruns;
+    return NULL;
+}
+
+static void bench_run(struct bench *b, const char *label, FILE *f)
+{
+    pthread_t th;
+    if (pthread_create(&th, NULL, bench_thread, b) != 0) {
+        fprintf(f, "%-8s could not start thread\n", label);
+        return;
+    }
+    pthread_join(th, NULL);
+
+    if (b->setup_err)
+        fprintf(f, "%-8s (setup failed: %s, numbers are for CFS)\n",
+                label, strerror(b->setup_err));
+    fprintf(f, "%-8s period mean %8.2f us  stddev %7.2f us  min %8.2f  max %8.2f  overruns %llu\n",
+            label, b->mean_us, b->stddev_us, b->min_us, b->max_us,
+            (unsigned long long)b->overruns);
+}
+
+void rt_jitter_bench(unsigned hz, unsigned ticks, const struct rt_config *cfg, FILE *f)
+{
+    struct bench off = { .hz = hz, .ticks = ticks, .cpu = -1, .prio = 0 };
+    struct bench on  = { .hz = hz, .ticks = ticks,
+                         .cpu = cfg->physics_cpu, .prio = cfg->physics_prio };
+
+    if (ticks == 0)
+        return;
+
+    fprintf(f, "jitter: %u ticks at %u Hz (%.1f us nominal)\n", ticks, hz, 1e6 / hz);
+    bench_run(&off, "normal", f);
+
+    rt_lock_memory();
+    if (cfg->isolate)
+        rt_isolate_cpu(cfg->physics_cpu);
+    bench_run(&on, "realtime", f);
+}
@@ -0,0 +1,38 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/* --realtime: physics and USB input each get a core of the dual-core
+   HPS and a SCHED_FIFO priority, memory is locked and prefaulted. */
+struct rt_config {
+    bool enabled;
+    bool isolate;          // also steer IRQs away from the physics core
+    int  physics_cpu;
+    int  input_cpu;
+    int  physics_prio;
+    int  input_prio;       // above physics so reports are reaped at once
+};
+
+void rt_defaults(struct rt_config *cfg);
+
+/* mlockall() and touch stack/heap now so page faults can't hit a tick. */
+int  rt_lock_memory(void);
+
+/* Pins the calling thread to cpu (-1 = leave) and makes it SCHED_FIFO
+   at prio (0 = leave SCHED_OTHER).  Returns 0 or an errno value. */
+int  rt_setup_thread(int cpu, int prio);
+
+/* Best effort: rewrites /proc/irq/<n>/smp_affinity to leave cpu alone.
+   Returns the number of IRQs moved.  The old masks go back at exit or
+   on SIGINT/SIGTERM, or earlier with rt_restore_irqs(). */
+int  rt_isolate_cpu(int cpu);
+void rt_restore_irqs(void);
+
+/* Runs the fixed-step scheduler for `ticks` periods at hz, first as an
+   ordinary thread and then with cfg applied, and prints the spread of
+   the measured tick period for both. */
+void rt_jitter_bench(unsigned hz, unsigned ticks, const struct rt_config *cfg, FILE *f);
+
+#endif
@@ -0,0 +1,184 @@
+#include "regbus.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------------ */
+/*  devmem / shm: a mapped 4 KiB window                                */
+
+struct mapped_bus {
+    struct regbus      bus;
+    volatile uint8_t  *mem;
+};
+
+static void mapped_write(struct regbus *b, uint32_t offset, uint32_t v)
+{
+    struct mapped_bus *m = (struct mapped_bus *)b;
+    *(volatile uint32_t *)(m->mem + offset) = v;
+}
+
+static uint32_t mapped_read(struct regbus *b, uint32_t offset)
+{
+    struct mapped_bus *m = (struct mapped_bus *)b;
+    return *(volatile uint32_t *)(m->mem + offset);
+}
+
+static void mapped_close(struct regbus *b)
+{
+    struct mapped_bus *m = (struct mapped_bus *)b;
+    munmap((void *)m->mem, LW_BRIDGE_SPAN);
+    free(m);
+}
+
+static const struct regbus_ops devmem_ops = {
+    .name  = "devmem",
+    .write = mapped_write,
+    .read  = mapped_read,
+    .close = mapped_close,
+};
+
+static const struct regbus_ops shm_ops = {
+    .name  = "shm",
+    .write = mapped_write,
+    .read  = mapped_read,
+    .close = mapped_close,
+};
+
+static struct regbus *map_open(const struct regbus_ops *ops, int fd, off_t base)
+{
+    void *mem = mmap(NULL, LW_BRIDGE_SPAN, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, base);
+    close(fd);
+    if (mem == MAP_FAILED) { perror("mmap"); return NULL; }
+
+    struct mapped_bus *m = calloc(1, sizeof *m);
+    if (!m) { munmap(mem, LW_BRIDGE_SPAN); return NULL; }
+    m->bus.ops = ops;
+    m->mem = mem;
+    return &m->bus;
+}
+
+static struct regbus *devmem_open(void)
+{
+    int fd = open("/dev/mem", O_RDWR | O_SYNC);
+    if (fd < 0) { perror("open(/dev/mem)"); return NULL; }
+    return map_open(&devmem_ops, fd, LW_BRIDGE_BASE);
+}
+
+static struct regbus *shm_open_path(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) { perror(path); return NULL; }
+    if (ftruncate(fd, LW_BRIDGE_SPAN) < 0) { perror("ftruncate"); close(fd); return NULL; }
+    return map_open(&shm_ops, fd, 0);
+}
+
+/* ------------------------------------------------------------------ */
+/*  model: the address decode from vga_ball.sv                          */
+
+struct vga_ball_regs {
+    uint16_t dino_x, dino_y;     // 0, 1
+    uint8_t  ducking, jumping;   // 13, 14
+    uint16_t lava_x, lava_y;     // 17, 18
+    uint8_t  replay;             // 19
+};
+
+struct model_bus {
+    struct regbus        bus;
+    struct vga_ball_regs regs;
+};
+
+static void model_write(struct regbus *b, uint32_t offset, uint32_t v)
+{
+    struct vga_ball_regs *r = &((struct model_bus *)b)->regs;
+
+    switch (offset >> 2) {
+    case 0:  r->dino_x  = v & 0x3FF; break;
+    case 1:  r->dino_y  = v & 0x3FF; break;
+    case 13: r->ducking = v & 1;     break;
+    case 14: r->jumping = v & 1;     break;
+    case 17: r->lava_x  = v & 0x3FF; break;
+    case 18: r->lava_y  = v & 0x3FF; break;
+    case 19: r->replay  = v & 1;     break;
+    default: break;                  // not decoded by the peripheral
+    }
+}
+
+/* vga_ball has no readdata port; hand back what the latches hold. */
+static uint32_t model_read(struct regbus *b, uint32_t offset)
+{
+    const struct vga_ball_regs *r = &((struct model_bus *)b)->regs;
+
+    switch (offset >> 2) {
+    case 0:  return r->dino_x;
+    case 1:  return r->dino_y;
+    case 13: return r->ducking;
+    case 14: return r->jumping;
+    case 17: return r->lava_x;
+    case 18: return r->lava_y;
+    case 19: return r->replay;
+    case 20: return 0x7;             // pushbutton PIO (motion4.c): none pressed
+    default: return 0;
+    }
+}
+
+static void model_close(struct regbus *b)
+{
+    free(b);
+}
+
+static const struct regbus_ops model_ops = {
+    .name  = "model",
+    .write = model_write,
+    .read  = model_read,
+    .close = model_close,
+};
+
+static struct regbus *model_open(void)
+{
+    struct model_bus *m = calloc(1, sizeof *m);
+    if (!m) return NULL;
+    m->bus.ops = &model_ops;
+    m->regs.dino_x = 100;            // power-on values in vga_ball.sv
+    m->regs.dino_y = 248;
+    m->regs.lava_x = 1800;
+    m->regs.lava_y = 248;
+    return &m->bus;
+}
+
+/* ------------------------------------------------------------------ */
+struct regbus *regbus_open(const char *spec)
+{
+    if (!spec || strcmp(spec, "devmem") == 0)
+        return devmem_open();
+    if (strncmp(spec, "shm:", 4) == 0)
+        return shm_open_path(spec + 4);
+    if (strcmp(spec, "model") == 0)
+        return model_open();
+#ifdef DINO_COSIM
+    if (strcmp(spec, "sim") == 0 || strncmp(spec, "sim:", 4) == 0)
+        return regbus_sim_open(spec + 3);
+#endif
+
+    fprintf(stderr, "unknown register bus '%s' (devmem, shm:<path>, model)\n", spec);
+    return NULL;
+}
+
+void regbus_close(struct regbus *b)
+{
+    if (b) b->ops->close(b);
+}
+
+void regbus_report(const struct regbus *b, FILE *f)
+{
+    unsigned long long frames = b->frames ? b->frames : 1;
+    fprintf(f, "bus %s: %llu writes, %llu reads over %llu frames (%.2f per frame)\n",
+            b->ops->name,
+            (unsigned long long)b->writes, (unsigned long long)b->reads,
+            (unsigned long long)b->frames,
+            (double)(b->writes + b->reads) / frames);
+    if (b->ops->report)
+        b->ops->report(b, f);
+}
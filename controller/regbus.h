@@ -0,0 +1,69 @@
+#ifndef REGBUS_H
+#define REGBUS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Register access for the vga_ball peripheral behind the LW bridge.
+ *
+ *   devmem        the real thing: /dev/mem mapped at 0xFF200000
+ *   shm:<path>    a 4 KiB shared file another process can mmap and watch
+ *   model         in-process copy of the vga_ball.sv register decode
+ *   sim[:opts]    the game itself (sim/dino_sim) on a virtual clock, for
+ *                 co-simulation; only with -DDINO_COSIM (regbus_sim.c)
+ *
+ * Offsets are byte offsets from the bridge base (register N is N*4).
+ */
+
+#define LW_BRIDGE_BASE  0xFF200000
+#define LW_BRIDGE_SPAN  0x1000
+
+struct regbus;
+
+struct regbus_ops {
+    const char *name;
+    void      (*write)(struct regbus *b, uint32_t offset, uint32_t v);
+    uint32_t  (*read)(struct regbus *b, uint32_t offset);
+    void      (*close)(struct regbus *b);
+    void      (*report)(const struct regbus *b, FILE *f);   // optional
+    void      (*frame)(struct regbus *b);                   // optional
+};
+
+struct regbus {
+    const struct regbus_ops *ops;
+    uint64_t writes;
+    uint64_t reads;
+    uint64_t frames;     // bumped by regbus_frame(), for per-frame averages
+};
+
+/* "devmem", "shm:/dev/shm/dino_regs", "model", "sim".  NULL means devmem. */
+struct regbus *regbus_open(const char *spec);
+void           regbus_close(struct regbus *b);
+
+static inline void regbus_write(struct regbus *b, uint32_t offset, uint32_t v)
+{
+    b->writes++;
+    b->ops->write(b, offset, v);
+}
+
+static inline uint32_t regbus_read(struct regbus *b, uint32_t offset)
+{
+    b->reads++;
+    return b->ops->read(b, offset);
+}
+
+static inline void regbus_frame(struct regbus *b)
+{
+    b->frames++;
+    if (b->ops->frame)
+        b->ops->frame(b);
+}
+
+void regbus_report(const struct regbus *b, FILE *f);
+
+#ifdef DINO_COSIM
+/* regbus_sim.c; opts is what follows "sim" in the spec. */
+struct regbus *regbus_sim_open(const char *opts);
+#endif
+
+#endif
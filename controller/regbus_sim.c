@@ -0,0 +1,193 @@
+/*  regbus_sim.c – "sim" register bus: vga_ball's game logic in-process
+ *
+ *  Writes land in a copy of the game (sim/dino_sim), which is kept
+ *  running at 50 MHz against tick_now_ns(): before each bus access the
+ *  model is advanced by the clocks that have gone by since the bus was
+ *  opened, so every write hits the motion period it would hit on the
+ *  board.  Opening the bus switches tick.c to virtual time, which makes
+ *  a controller run flat out and the same way every time -- the 5 ms
+ *  physics loop against the 2,000,000-clock motion tick can be replayed
+ *  exactly.
+ *
+ *    sim[:secs=N][:trace=PATH]
+ *
+ *  secs=N    raise SIGTERM after N virtual seconds (the controllers
+ *            shut down and report on it)
+ *  trace=PATH  one line per motion tick and per game over / replay:
+ *            time, dino registers, score, game_over, the obstacles
+ *
+ *  Only built into programs compiled with -DDINO_COSIM, together with
+ *  ../sim/dino_sim.c.
+ */
+
+#include "regbus.h"
+#include "tick.h"
+#include "../sim/dino_sim.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_CLOCK_HZ  50000000ull
+
+struct sim_bus {
+    struct regbus      bus;
+    struct dino_state  game;
+    uint64_t           t0_ns;
+    uint64_t           stop_ns;         // 0 = run until killed
+    bool               stopped;
+    FILE              *trace;
+
+    uint64_t           motion_ticks;
+    uint64_t           game_overs;
+    uint32_t           best_score;
+};
+
+static void trace_tick(struct sim_bus *m)
+{
+    const struct dino_state *s = &m->game;
+
+    fprintf(m->trace, "%.3f x=%u y=%u jump=%u duck=%u score=%u over=%u "
+                      "cac=%u group=%u lava=%u ptr=%u powerup=%u\n",
+            s->cycles * 1e3 / SIM_CLOCK_HZ, s->dino_x, s->dino_y, s->jumping,
+            s->ducking, s->score, s->game_over, s->s_cac_x, s->group_x,
+            s->lava_x, s->ptr_x, s->powerup_x);
+}
+
+/* Runs the model up to now, a motion period at most per step so every
+   tick (and the clock the game ends on) can be looked at. */
+static void catch_up(struct sim_bus *m)
+{
+    uint64_t now = tick_now_ns();
+    uint64_t dt = now - m->t0_ns;     // dt * SIM_CLOCK_HZ overflows after 368 s
+    uint64_t target = dt / 1000000000ull * SIM_CLOCK_HZ
+                    + dt % 1000000000ull * SIM_CLOCK_HZ / 1000000000ull;
+    struct dino_state *s = &m->game;
+
+    while (s->cycles < target) {
+        uint64_t n = DINO_MOTION_LIMIT - s->motion_timer + 1;   // through the next update
+        uint8_t  over = s->game_over;
+        bool     tick = !over;
+
+        if (n > target - s->cycles) {
+            n = target - s->cycles;
+            tick = false;
+        }
+        // stop at a collision: a held REPLAY would clear it a clock later
+        if (dino_sim_run_until_over(s, n) < n)
+            tick = false;
+
+        if (tick) {
+            m->motion_ticks++;
+            if (s->score > m->best_score)
+                m->best_score = s->score;
+        }
+        if (s->game_over && !over)
+            m->game_overs++;
+        if (m->trace && (tick || s->game_over != over))
+            trace_tick(m);
+    }
+
+    if (m->stop_ns && !m->stopped && now - m->t0_ns >= m->stop_ns) {
+        m->stopped = true;
+        raise(SIGTERM);
+    }
+}
+
+static void sim_write(struct regbus *b, uint32_t offset, uint32_t v)
+{
+    struct sim_bus *m = (struct sim_bus *)b;
+
+    catch_up(m);
+    dino_sim_write(&m->game, offset >> 2, v);
+}
+
+/* Like the model bus: what the latches hold. */
+static uint32_t sim_read(struct regbus *b, uint32_t offset)
+{
+    struct sim_bus *m = (struct sim_bus *)b;
+    const struct dino_state *s = &m->game;
+
+    catch_up(m);
+    switch (offset >> 2) {
+    case DINO_REG_DINO_X:  return s->dino_x;
+    case DINO_REG_DINO_Y:  return s->dino_y;
+    case DINO_REG_DUCKING: return s->ducking;
+    case DINO_REG_JUMPING: return s->jumping;
+    case DINO_REG_LAVA_X:  return s->lava_x;
+    case DINO_REG_LAVA_Y:  return s->lava_y;
+    case DINO_REG_REPLAY:  return s->replay_button;
+    case 20:               return 0x7;      // pushbutton PIO (motion4.c): none pressed
+    default:               return 0;
+    }
+}
+
+static void sim_close(struct regbus *b)
+{
+    struct sim_bus *m = (struct sim_bus *)b;
+
+    if (m->trace)
+        fclose(m->trace);
+    free(m);
+}
+
+static void sim_report(const struct regbus *b, FILE *f)
+{
+    const struct sim_bus *m = (const struct sim_bus *)b;
+
+    fprintf(f, "sim: %.3f s virtual, %llu motion ticks, %llu game overs, "
+               "best score %u, score now %u\n",
+            m->game.cycles / (double)SIM_CLOCK_HZ,
+            (unsigned long long)m->motion_ticks, (unsigned long long)m->game_overs,
+            m->best_score, m->game.score);
+}
+
+/* Keeps the game (and secs=) going while the controller writes nothing. */
+static void sim_frame(struct regbus *b)
+{
+    catch_up((struct sim_bus *)b);
+}
+
+static const struct regbus_ops sim_ops = {
+    .name   = "sim",
+    .write  = sim_write,
+    .read   = sim_read,
+    .close  = sim_close,
+    .report = sim_report,
+    .frame  = sim_frame,
+};
+
+struct regbus *regbus_sim_open(const char *opts)
+{
+    struct sim_bus *m = calloc(1, sizeof *m);
+    if (!m) return NULL;
+    m->bus.ops = &sim_ops;
+
+    while (opts && *opts == ':') {
+        const char *opt = opts + 1;
+        size_t len = strcspn(opt, ":");
+
+        if (strncmp(opt, "secs=", 5) == 0) {
+            m->stop_ns = (uint64_t)(strtod(opt + 5, NULL) * 1e9);
+        } else if (strncmp(opt, "trace=", 6) == 0) {
+            char path[256];
+            snprintf(path, sizeof path, "%.*s", (int)len - 6, opt + 6);
+            if (!(m->trace = fopen(path, "w"))) {
+                perror(path);
+                free(m);
+                return NULL;
+            }
+        } else {
+            fprintf(stderr, "sim bus: unknown option '%.*s' (secs=N, trace=PATH)\n",
+                    (int)len, opt);
+            if (m->trace) fclose(m->trace);
+            free(m);
+            return NULL;
+        }
+        opts = opt + len;
+    }
+
+    tick_virtual();
+    m->t0_ns = tick_now_ns();
+    dino_sim_init(&m->game);
+    return &m->bus;
+}
@@ -0,0 +1,28 @@
+#include "shadow_regs.h"
+#include <string.h>
+
+void shadow_init(struct shadow_regs *s, struct regbus *bus)
+{
+    memset(s, 0, sizeof *s);
+    s->bus = bus;
+}
+
+int shadow_flush(struct shadow_regs *s)
+{
+    uint32_t pending = s->dirty;
+    int n = 0;
+
+    while (pending) {
+        unsigned i = __builtin_ctz(pending);
+        pending &= pending - 1;
+
+        regbus_write(s->bus, i << 2, s->value[i]);
+        s->hw[i] = s->value[i];
+        n++;
+    }
+
+    s->known |= s->dirty;
+    s->dirty = 0;
+    s->writes += n;
+    return n;
+}
@@ -0,0 +1,53 @@
+#ifndef SHADOW_REGS_H
+#define SHADOW_REGS_H
+
+#include <stdint.h>
+#include "regbus.h"
+
+/* Normal-memory copy of the vga_ball register window.  Writes go to the
+   copy and only registers whose value actually changed are pushed over
+   the register bus, once per frame, in address order.  Offsets are
+   byte offsets from the bridge base, like pio_write(). */
+
+#define SHADOW_NREGS 32
+
+struct shadow_regs {
+    struct regbus *bus;
+    uint32_t value[SHADOW_NREGS];   // what software wants
+    uint32_t hw[SHADOW_NREGS];      // what was last written to the bridge
+    uint32_t dirty;                 // bit i: value[i] != hw[i]
+    uint32_t known;                 // bit i: hw[i] is valid
+    uint64_t sets;                  // shadow_set() calls
+    uint64_t writes;                // bridge writes actually issued
+};
+
+void shadow_init(struct shadow_regs *s, struct regbus *bus);
+
+static inline uint32_t shadow_get(const struct shadow_regs *s, uint32_t offset)
+{
+    return s->value[offset >> 2];
+}
+
+static inline void shadow_set(struct shadow_regs *s, uint32_t offset, uint32_t v)
+{
+    unsigned i = offset >> 2;
+    uint32_t bit = 1u << i;
+
+    s->sets++;
+    s->value[i] = v;
+    if ((s->known & bit) && s->hw[i] == v)
+        s->dirty &= ~bit;
+    else
+        s->dirty |= bit;
+}
+
+/* Writes every dirty register, lowest offset first.  Returns the count. */
+int  shadow_flush(struct shadow_regs *s);
+
+/* Bridge transactions avoided so far. */
+static inline uint64_t shadow_saved(const struct shadow_regs *s)
+{
+    return s->sets - s->writes;
+}
+
+#endif
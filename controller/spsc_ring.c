@@ -0,0 +1,24 @@
+#include "spsc_ring.h"
+#include <stdlib.h>
+
+int spsc_init(struct spsc_ring *r, uint32_t capacity, uint32_t elem_size)
+{
+    memset(r, 0, sizeof *r);
+    if (capacity == 0 || (capacity & (capacity - 1)))
+        return -1;
+
+    void *slots;
+    if (posix_memalign(&slots, SPSC_CACHE_LINE, (size_t)capacity * elem_size))
+        return -1;
+
+    r->slots     = slots;
+    r->mask      = capacity - 1;
+    r->elem_size = elem_size;
+    return 0;
+}
+
+void spsc_free(struct spsc_ring *r)
+{
+    free(r->slots);
+    r->slots = NULL;
+}
@@ -0,0 +1,98 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Lock-free single-producer / single-consumer ring of fixed-size
+ * elements.  Head and tail are free-running counters on their own cache
+ * lines; each side also keeps a private copy of the other side's index
+ * so it only touches the shared line when it looks full / empty.
+ */
+
+#define SPSC_CACHE_LINE 64
+
+struct spsc_ring {
+    /* producer */
+    uint32_t head __attribute__((aligned(SPSC_CACHE_LINE)));
+    uint32_t tail_cache;
+    uint32_t dropped;         // pushes refused because the ring was full
+    uint32_t high_water;      // most elements ever waiting at once
+
+    /* consumer */
+    uint32_t tail __attribute__((aligned(SPSC_CACHE_LINE)));
+    uint32_t head_cache;
+
+    /* read-only after init */
+    uint32_t mask __attribute__((aligned(SPSC_CACHE_LINE)));
+    uint32_t elem_size;
+    unsigned char *slots;
+};
+
+/* capacity must be a power of two.  Returns 0 or -1 (no memory). */
+int  spsc_init(struct spsc_ring *r, uint32_t capacity, uint32_t elem_size);
+void spsc_free(struct spsc_ring *r);
+
+/* Producer side.  Returns false (and counts a drop) when full. */
+static inline bool spsc_push(struct spsc_ring *r, const void *elem)
+{
+    uint32_t head = r->head;
+
+    if (head - r->tail_cache > r->mask) {
+        r->tail_cache = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+        if (head - r->tail_cache > r->mask) {
+            __atomic_store_n(&r->dropped, r->dropped + 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+
+    memcpy(r->slots + (size_t)(head & r->mask) * r->elem_size, elem, r->elem_size);
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+
+    // A relaxed peek at the real tail; tail_cache can be arbitrarily stale.
+    uint32_t used = head + 1 - __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    if (used > r->high_water)
+        __atomic_store_n(&r->high_water, used, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* Producer side: would a push fail right now? */
+static inline bool spsc_full(struct spsc_ring *r)
+{
+    return r->head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) > r->mask;
+}
+
+/* Consumer side.  Copies up to max elements into out, oldest first. */
+static inline uint32_t spsc_pop(struct spsc_ring *r, void *out, uint32_t max)
+{
+    uint32_t tail = r->tail;
+
+    if (r->head_cache == tail)
+        r->head_cache = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+
+    uint32_t n = r->head_cache - tail;
+    if (n > max)
+        n = max;
+
+    for (uint32_t i = 0; i < n; ++i)
+        memcpy((unsigned char *)out + (size_t)i * r->elem_size,
+               r->slots + (size_t)((tail + i) & r->mask) * r->elem_size,
+               r->elem_size);
+
+    __atomic_store_n(&r->tail, tail + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+/* Either side may read these; they are only approximate while running. */
+static inline uint32_t spsc_dropped(const struct spsc_ring *r)
+{
+    return __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t spsc_high_water(const struct spsc_ring *r)
+{
+    return __atomic_load_n(&r->high_water, __ATOMIC_RELAXED);
+}
+
+#endif
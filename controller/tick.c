@@ -0,0 +1,96 @@
+#include "tick.h"
+#include <errno.h>
+#include <time.h>
+
+#define DEFAULT_MAX_CATCH_UP 4
+
+static bool     virtual_time;
+static uint64_t virtual_ns;
+
+uint64_t tick_now_ns(void)
+{
+    if (virtual_time)
+        return virtual_ns;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void tick_virtual(void)
+{
+    virtual_time = true;
+    virtual_ns   = 0;
+}
+
+bool tick_is_virtual(void)
+{
+    return virtual_time;
+}
+
+static void sleep_until(uint64_t deadline_ns)
+{
+    if (virtual_time) {
+        if (deadline_ns > virtual_ns)
+            virtual_ns = deadline_ns;
+        return;
+    }
+
+    struct timespec ts = {
+        .tv_sec  = deadline_ns / 1000000000ull,
+        .tv_nsec = deadline_ns % 1000000000ull,
+    };
+
+    // A signal only cuts the sleep short; the deadline doesn't move.
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+void tick_sleep_ns(uint64_t ns)
+{
+    sleep_until(tick_now_ns() + ns);
+}
+
+void tick_init(struct tick_sched *t, unsigned hz, enum tick_policy policy)
+{
+    t->period_ns    = 1000000000ull / hz;
+    t->next_ns      = tick_now_ns() + t->period_ns;
+    t->policy       = policy;
+    t->max_catch_up = DEFAULT_MAX_CATCH_UP;
+    t->ticks = t->overruns = t->skipped = t->max_late_ns = 0;
+}
+
+unsigned tick_wait(struct tick_sched *t)
+{
+    sleep_until(t->next_ns);
+
+    uint64_t now  = tick_now_ns();
+    uint64_t late = now > t->next_ns ? now - t->next_ns : 0;
+    if (late > t->max_late_ns)
+        t->max_late_ns = late;
+
+    // Deadlines between the one we slept for and now were missed outright.
+    uint64_t missed = late / t->period_ns;
+    unsigned steps  = 1;
+
+    if (missed) {
+        t->overruns++;
+        if (t->policy == TICK_CATCH_UP)
+            steps += missed < t->max_catch_up ? missed : t->max_catch_up;
+        t->skipped += missed + 1 - steps;
+    }
+
+    t->next_ns += (missed + 1) * t->period_ns;
+    t->ticks   += steps;
+    return steps;
+}
+
+void tick_report(const struct tick_sched *t, FILE *f)
+{
+    fprintf(f, "ticks %llu @ %llu us, overruns %llu, skipped %llu, max late %llu us\n",
+            (unsigned long long)t->ticks,
+            (unsigned long long)(t->period_ns / 1000),
+            (unsigned long long)t->overruns,
+            (unsigned long long)t->skipped,
+            (unsigned long long)(t->max_late_ns / 1000));
+}
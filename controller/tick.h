@@ -0,0 +1,49 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* What to do when one or more deadlines have already passed. */
+enum tick_policy {
+    TICK_CATCH_UP,   // run the missed steps back to back (up to max_catch_up)
+    TICK_SKIP,       // drop the missed steps and run just one
+};
+
+/* Fixed-timestep scheduler on absolute CLOCK_MONOTONIC deadlines.
+   Deadlines stay on the period grid, so sleeping late never drifts. */
+struct tick_sched {
+    uint64_t         period_ns;
+    uint64_t         next_ns;        // deadline of the next tick
+    enum tick_policy policy;
+    unsigned         max_catch_up;
+
+    uint64_t         ticks;          // steps handed to the caller
+    uint64_t         overruns;       // wakeups that missed at least one deadline
+    uint64_t         skipped;        // steps dropped by the policy
+    uint64_t         max_late_ns;    // worst wakeup lateness seen
+};
+
+void     tick_init(struct tick_sched *t, unsigned hz, enum tick_policy policy);
+
+/* Sleeps until the next deadline.  Returns how many fixed steps the
+   caller should run now (always at least 1). */
+unsigned tick_wait(struct tick_sched *t);
+
+uint64_t tick_now_ns(void);
+
+/* Sleeps ns, like usleep() but on the tick clock. */
+void     tick_sleep_ns(uint64_t ns);
+
+/* Virtual time, for co-simulation: from here on tick_now_ns() reads a
+   clock that starts at 0 and only moves when tick_wait() or
+   tick_sleep_ns() move it, straight to the deadline.  Nothing sleeps,
+   so the program runs as fast as the host allows and a run is the same
+   every time.  Only one thread should move it. */
+void     tick_virtual(void);
+bool     tick_is_virtual(void);
+
+void     tick_report(const struct tick_sched *t, FILE *f);
+
+#endif
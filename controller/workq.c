@@ -0,0 +1,199 @@
+#include "workq.h"
+#include "realtime.h"
+#include <sched.h>
+#include <string.h>
+
+struct workq_job {
+    void     (*fn)(void *ctx, unsigned i);
+    void      *ctx;
+    unsigned   remaining;              // atomic
+};
+
+/* Next index from our own range. */
+static int take(struct workq_slot *s, struct workq_job **job, unsigned *i)
+{
+    int ok = 0;
+
+    pthread_mutex_lock(&s->lock);
+    if (s->lo < s->hi) {
+        *i   = s->lo++;
+        *job = s->job;
+        ok   = 1;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+/* Slot locks are only ever taken in index order. */
+static void lock_pair(struct workq *q, unsigned a, unsigned b)
+{
+    pthread_mutex_lock(&q->slot[a < b ? a : b].lock);
+    pthread_mutex_lock(&q->slot[a < b ? b : a].lock);
+}
+
+static void unlock_pair(struct workq *q, unsigned a, unsigned b)
+{
+    pthread_mutex_unlock(&q->slot[a].lock);
+    pthread_mutex_unlock(&q->slot[b].lock);
+}
+
+/* Back half of the biggest range elsewhere becomes ours.  Returns 0 when
+   there is nothing left to take anywhere. */
+static int steal(struct workq *q, unsigned self)
+{
+    for (;;) {
+        unsigned victim = self, best = 0;
+
+        for (unsigned k = 0; k < q->threads; k++) {
+            unsigned left = __atomic_load_n(&q->slot[k].hi, __ATOMIC_RELAXED) -
+                            __atomic_load_n(&q->slot[k].lo, __ATOMIC_RELAXED);
+            if (k != self && left > best && left < 0x80000000u) {
+                best   = left;
+                victim = k;
+            }
+        }
+        if (victim == self)
+            return 0;
+
+        struct workq_slot *v = &q->slot[victim], *me = &q->slot[self];
+        int got = 0;
+
+        lock_pair(q, self, victim);
+        if (me->lo < me->hi) {
+            got = 1;                   /* a new job dealt us some */
+        } else if (v->lo < v->hi) {
+            unsigned mid = v->lo + (v->hi - v->lo) / 2;
+            me->lo  = mid;
+            me->hi  = v->hi;
+            me->job = v->job;
+            v->hi   = mid;
+            me->steals++;
+            got = 1;
+        }
+        unlock_pair(q, self, victim);
+
+        if (got)
+            return 1;
+    }
+}
+
+static void work(struct workq *q, unsigned self)
+{
+    struct workq_job *job;
+    unsigned i;
+
+    do {
+        while (take(&q->slot[self], &job, &i)) {
+            job->fn(job->ctx, i);
+            __atomic_sub_fetch(&job->remaining, 1, __ATOMIC_RELEASE);
+        }
+    } while (steal(q, self));
+}
+
+static void *worker(void *p)
+{
+    struct workq_arg *a = p;
+    struct workq *q = a->q;
+    uint64_t seen = 0;
+
+    if (q->first_cpu >= 0 || q->prio)
+        rt_setup_thread(q->first_cpu >= 0 ? q->first_cpu + (int)a->self : -1, q->prio);
+
+    for (;;) {
+        pthread_mutex_lock(&q->lock);
+        while (!q->quit && q->generation == seen)
+            pthread_cond_wait(&q->wake, &q->lock);
+        seen = q->generation;
+        int quit = q->quit;
+        pthread_mutex_unlock(&q->lock);
+
+        if (quit)
+            return NULL;
+        work(q, a->self);
+    }
+}
+
+int workq_init(struct workq *q, unsigned threads, int first_cpu, int prio)
+{
+    memset(q, 0, sizeof *q);
+    if (threads < 1)
+        threads = 1;
+    if (threads > WORKQ_MAX_THREADS)
+        threads = WORKQ_MAX_THREADS;
+
+    q->first_cpu = first_cpu;
+    q->prio      = prio;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->wake, NULL);
+    for (unsigned k = 0; k < threads; k++)
+        pthread_mutex_init(&q->slot[k].lock, NULL);
+
+    q->threads = 1;
+    for (unsigned k = 1; k < threads; k++) {
+        q->arg[k] = (struct workq_arg){ q, k };
+        int r = pthread_create(&q->tid[k], NULL, worker, &q->arg[k]);
+        if (r) {
+            workq_destroy(q);
+            return r;
+        }
+        q->threads = k + 1;
+    }
+    return 0;
+}
+
+void workq_destroy(struct workq *q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->quit = 1;
+    pthread_cond_broadcast(&q->wake);
+    pthread_mutex_unlock(&q->lock);
+
+    for (unsigned k = 1; k < q->threads; k++)
+        pthread_join(q->tid[k], NULL);
+    q->threads = 1;
+}
+
+void workq_run(struct workq *q, unsigned n, void (*fn)(void *ctx, unsigned i), void *ctx)
+{
+    struct workq_job job = { fn, ctx, n };
+    unsigned per = (n + q->threads - 1) / q->threads;
+
+    if (n == 0)
+        return;
+
+    /* deal the indices out evenly, all at once so nobody steals from a
+       half-dealt table; stealing fixes the imbalance */
+    for (unsigned k = 0; k < q->threads; k++)
+        pthread_mutex_lock(&q->slot[k].lock);
+    for (unsigned k = 0; k < q->threads; k++) {
+        unsigned lo = k * per < n ? k * per : n;
+        unsigned hi = lo + per < n ? lo + per : n;
+
+        q->slot[k].lo  = lo;
+        q->slot[k].hi  = hi;
+        q->slot[k].job = &job;
+    }
+    for (unsigned k = 0; k < q->threads; k++)
+        pthread_mutex_unlock(&q->slot[k].lock);
+
+    pthread_mutex_lock(&q->lock);
+    q->generation++;
+    pthread_cond_broadcast(&q->wake);
+    pthread_mutex_unlock(&q->lock);
+
+    work(q, 0);
+    while (__atomic_load_n(&job.remaining, __ATOMIC_ACQUIRE))
+        if (!steal(q, 0))
+            sched_yield();
+        else
+            work(q, 0);
+}
+
+uint64_t workq_steals(const struct workq *q)
+{
+    uint64_t n = 0;
+
+    for (unsigned k = 0; k < q->threads; k++)
+        n += q->slot[k].steals;
+    return n;
+}
@@ -0,0 +1,55 @@
+#ifndef WORKQ_H
+#define WORKQ_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+/* Parallel-for over [0, n) on a fixed set of threads, by range stealing.
+ *
+ * Each worker owns a range of indices and takes them one at a time from
+ * the front.  A worker that runs dry takes the back half of the largest
+ * range it can find.  The caller is worker 0 and workq_run() returns once
+ * every index has been run.
+ */
+
+#define WORKQ_MAX_THREADS 16
+
+struct workq_job;
+
+struct workq_slot {
+    pthread_mutex_t   lock;
+    unsigned          lo, hi;          // indices still owned
+    struct workq_job *job;             // which parallel-for they belong to
+    uint64_t          steals;          // ranges this worker took from others
+} __attribute__((aligned(64)));
+
+struct workq_arg {
+    struct workq     *q;
+    unsigned          self;
+};
+
+struct workq {
+    unsigned          threads;
+    struct workq_arg  arg[WORKQ_MAX_THREADS];
+    struct workq_slot slot[WORKQ_MAX_THREADS];
+    pthread_t         tid[WORKQ_MAX_THREADS];
+
+    pthread_mutex_t   lock;            // guards generation/quit for sleepers
+    pthread_cond_t    wake;
+    uint64_t          generation;
+    int               quit;
+
+    int               prio;            // SCHED_FIFO for the workers, 0 = none
+    int               first_cpu;       // worker k on first_cpu + k, -1 = unpinned
+};
+
+/* Starts threads - 1 workers.  Returns 0 or an errno value. */
+int  workq_init(struct workq *q, unsigned threads, int first_cpu, int prio);
+void workq_destroy(struct workq *q);
+
+/* Runs fn(ctx, i) for every i in [0, n) and waits for all of them. */
+void workq_run(struct workq *q, unsigned n, void (*fn)(void *ctx, unsigned i), void *ctx);
+
+uint64_t workq_steals(const struct workq *q);
+
+#endif
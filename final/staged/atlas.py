@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""
+Pack the sprites into the ROMs vga_ball.sv reads them from.
+
+    cd final/staged && python3 atlas.py
+
+Every sprite gets its own RGB565 palette holding every colour it has, and
+is stored as 9-bit indices into it, plus a 1-bit mask plane saying which
+pixels are drawn.  Nothing is quantized: a sprite with more than 512
+colours is an error.  Transparent pixels (the magenta key or white in
+the sources, as is_visible() used to test) get mask 0 and index 0.
+Sources are the RGB565 .hex files or, with Pillow, .png files (fully
+transparent pixels become the key, as in png2rgb565_hex.py).
+
+Writes:
+
+  sprite_atlas.hex    ATLAS_WORDS indices, one per line
+  sprite_mask.hex     the mask, 32 pixels a word: bit i of word w is
+                      atlas address 32 * w + i, so a word is one row of
+                      a 32-wide sprite (two words a row of the group)
+  sprite_palette.hex  PAL_WORDS words, the palette RAM's start-up contents
+  sprite_atlas.svh    offsets and palette numbers, `included by vga_ball.sv,
+                      and the same by sprite id (= palette number) for its
+                      object engine: SPRITE_BASE, SPRITE_WIDTH and
+                      SPRITE_WRAP (words - 1, where a row address wraps),
+                      and by palette number PAL_BASE and PAL_MASK
+
+Every sprite sits at a multiple of its own size, the 64x32 cactus group
+first; short files are padded with word 0000, which is what $readmemh
+left past the end of a file, and the free space at the end is index 0.
+Palettes are the next power of two up from their colours and sit at a
+multiple of it in the palette RAM, so colour i of palette p is at
+PAL_BASE[p] | (i & PAL_MASK[p]), whichever sprite's indices are drawn
+through it.  A new sprite or animation frame is one more line in SPRITES.
+"""
+
+import sys
+from pathlib import Path
+
+ATLAS_WORDS = 16384
+INDEX_BITS = 9
+PALETTES = 16
+PAL_WORDS = 2048
+
+KEY = 0xF81F                    # transparent in the sources, as is white
+TRANSPARENT = (0xF81F, 0xFFFF)
+MASK_BITS = 32
+
+# (name in sprite_atlas.svh, source relative to final/, words, width);
+# every sprite is 32 rows, and the replay banner's 1024 words wrap
+SPRITES = [
+    ("GROUP",       "../better_cactus_64x32.hex",  2048,  64),
+    ("S_CAC",       "s_cac_sprite.hex",            1024,  32),
+    ("LAVA",        "lava_sprite.hex",             1024,  32),
+    ("PTR_DOWN",    "pterodactyle_wingdown.hex",   1024,  32),
+    ("PTR_UP",      "pterodactyle_wingup.hex",     1024,  32),
+    ("DINO",        "dino_sprite.hex",             1024,  32),
+    ("DUCK",        "duck_sprite.hex",             1024,  32),
+    ("JUMP",        "jump_sprite.hex",             1024,  32),
+    ("LEFT_LEG",    "dino_left_leg_up.hex",        1024,  32),
+    ("RIGHT_LEG",   "dino_right_leg_up.hex",       1024,  32),
+    ("POWERUP",     "powerup_sprite.hex",          1024,  32),
+    ("GODZILLA",    "godzilla_sprite.hex",         1024,  32),
+    ("REPLAY",      "replay.hex",                  1024, 160),
+]
+
+
+def read_hex(path, words):
+    """$readmemh: words separated by white space, // comments, @address."""
+    mem = [0] * words
+    at = 0
+    for line in path.read_text().splitlines():
+        for tok in line.split("//")[0].split():
+            if tok.startswith("@"):
+                at = int(tok[1:], 16)
+                continue
+            if at >= words:
+                sys.exit(f"{path}: more than {words} words")
+            mem[at] = int(tok, 16)
+            at += 1
+    return mem
+
+
+def read_png(path, words):
+    """32 pixels a row, RGB565, transparent pixels as the key."""
+    from PIL import Image
+
+    im = Image.open(path).convert("RGBA")
+    im = im.resize((32, words // 32), Image.NEAREST)
+    mem = []
+    for y in range(im.height):
+        for x in range(im.width):
+            r, g, b, a = im.getpixel((x, y))
+            mem.append(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3) if a else KEY)
+    return mem
+
+
+def read_sprite(path, words):
+    return read_png(path, words) if path.suffix == ".png" else read_hex(path, words)
+
+
+def split565(w):
+    return (w >> 11, (w >> 5) & 0x3F, w & 0x1F)
+
+
+def index_sprite(words):
+    """(indices, mask, palette, colours) for one sprite, every colour it
+    has in the palette, most used first."""
+    counts = {}
+    for w in words:
+        if w not in TRANSPARENT:
+            counts[w] = counts.get(w, 0) + 1
+    palette = sorted(counts, key=lambda w: (-counts[w], w))
+    index = {w: i for i, w in enumerate(palette)}
+    indices = [index.get(w, 0) for w in words]
+    mask = [w not in TRANSPARENT for w in words]
+    return indices, mask, palette, len(palette)
+
+
+def pack_palettes(palettes):
+    """(base, size) by palette number, each size a power of two at a
+    multiple of itself, biggest first; and the palette RAM's contents."""
+    size = [1 << max(len(p) - 1, 0).bit_length() for p in palettes]
+    place, at = {}, 0
+    for pal in sorted(range(len(palettes)), key=lambda p: (-size[p], p)):
+        place[pal] = at
+        at += size[pal]
+    if at > PAL_WORDS:
+        sys.exit(f"palettes need {at} words, the RAM has {PAL_WORDS}")
+    ram = [0] * PAL_WORDS
+    for pal, colours in enumerate(palettes):
+        ram[place[pal]:place[pal] + len(colours)] = colours
+    return [(place[p], size[p]) for p in range(len(palettes))], ram
+
+
+def main():
+    here = Path(__file__).resolve().parent
+    atlas = []
+    mask = []
+    palettes = []
+    offsets = []
+
+    if len(SPRITES) > PALETTES:
+        sys.exit(f"{len(SPRITES)} sprites, {PALETTES} palettes")
+    for name, file, words, width in SPRITES:
+        if width % 2 or width > 255 or words & (words - 1):
+            sys.exit(f"{name}: widths are even and below 256, sizes powers of 2")
+        if len(atlas) % words:
+            mask += [False] * (words - len(atlas) % words)
+            atlas += [0] * (words - len(atlas) % words)
+        indices, opaque, palette, colours = index_sprite(read_sprite(here.parent / file, words))
+        if colours > 1 << INDEX_BITS:
+            sys.exit(f"{name}: {colours} colours, a palette holds {1 << INDEX_BITS}")
+        offsets.append((name, len(atlas), words, file, colours, width))
+        atlas += indices
+        mask += opaque
+        palettes.append(palette)
+    if len(atlas) > ATLAS_WORDS:
+        sys.exit(f"atlas needs {len(atlas)} words, ROM has {ATLAS_WORDS}")
+    used = len(atlas)
+    atlas += [0] * (ATLAS_WORDS - used)
+    mask += [False] * (ATLAS_WORDS - used)
+    places, ram = pack_palettes(palettes)
+
+    with (here / "sprite_atlas.hex").open("w") as f:
+        for index in atlas:
+            f.write(f"{index:03X}\n")
+    with (here / "sprite_mask.hex").open("w") as f:
+        for w in range(0, ATLAS_WORDS, MASK_BITS):
+            word = sum(bit << i for i, bit in enumerate(mask[w:w + MASK_BITS]))
+            f.write(f"{word:08X}\n")
+    with (here / "sprite_palette.hex").open("w") as f:
+        for word in ram:
+            f.write(f"{word:04X}\n")
+
+    bits = (ATLAS_WORDS - 1).bit_length()
+    pbits = (PALETTES - 1).bit_length()
+    rbits = (PAL_WORDS - 1).bit_length()
+    with (here / "sprite_atlas.svh").open("w") as f:
+        f.write("// Generated by atlas.py from the sprite sources -- do not edit.\n")
+        f.write(f"localparam int ATLAS_WORDS = {ATLAS_WORDS};\n")
+        f.write(f"localparam int ATLAS_BITS  = {bits};\n")
+        f.write(f"localparam int INDEX_BITS  = {INDEX_BITS};\n")
+        f.write(f"localparam int PALETTES    = {PALETTES};\n")
+        f.write(f"localparam int PAL_WORDS   = {PAL_WORDS};\n")
+        f.write(f"localparam int PAL_BITS    = {rbits};\n")
+        for name, base, words, file, colours, width in offsets:
+            value = f"{bits}'d{base};"
+            f.write(f"localparam logic [{bits - 1}:0] ATLAS_{name:<10} = {value:<10}"
+                    f"  // {words:4} words, {Path(file).name}\n")
+        for pal, (name, base, words, file, colours, width) in enumerate(offsets):
+            value = f"{pbits}'d{pal};"
+            f.write(f"localparam logic [{pbits - 1}:0] PAL_{name:<10} = {value:<10}"
+                    f"  // {colours} colours at {places[pal][0]}\n")
+
+        def array(width, values):
+            return "'{" + ", ".join(f"{width}'d{v}" for v in values) + "}"
+
+        f.write(f"localparam int SPRITE_IDS = {len(offsets)};\n")
+        f.write(f"localparam logic [{bits - 1}:0] SPRITE_BASE  [SPRITE_IDS] = "
+                f"{array(bits, (o[1] for o in offsets))};\n")
+        f.write(f"localparam logic [7:0]  SPRITE_WIDTH [SPRITE_IDS] = "
+                f"{array(8, (o[5] for o in offsets))};\n")
+        f.write(f"localparam logic [{bits - 1}:0] SPRITE_WRAP  [SPRITE_IDS] = "
+                f"{array(bits, (o[2] - 1 for o in offsets))};\n")
+        # palettes past the sprites' are colour 0
+        places += [(0, 1)] * (PALETTES - len(places))
+        f.write(f"localparam logic [{rbits - 1}:0] PAL_BASE [PALETTES] = "
+                f"{array(rbits, (p[0] for p in places))};\n")
+        f.write(f"localparam logic [{INDEX_BITS - 1}:0]  PAL_MASK [PALETTES] = "
+                f"{array(INDEX_BITS, (p[1] - 1 for p in places))};\n")
+
+    print(f"sprite_atlas.hex: {len(SPRITES)} sprites, {used} of {ATLAS_WORDS} indices")
+    print(f"sprite_palette.hex: {sum(len(p) for p in palettes)} colours, "
+          f"{sum(p[1] for p in places[:len(palettes)])} of {PAL_WORDS} words")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,28 @@
+// One bank of a sprite line buffer: 1024 pixels of {valid, priority,
+// palette RAM address}, one write port and one read port.  vga_ball.sv
+// keeps two buffers of two banks each (even and odd x) so the object
+// engine can write two pixels a clock into one buffer while the other is
+// on screen.
+// Inferred as simple dual-port block RAM.
+module line_buffer (
+    input  logic        clk,
+    input  logic        write,
+    input  logic [9:0]  write_address,
+    input  logic [14:0] writedata,
+    input  logic [9:0]  address,
+    output logic [14:0] data
+);
+
+    logic [14:0] memory [0:1023];
+
+    initial begin
+        for (int i = 0; i < 1024; i++)
+            memory[i] = 15'd0;
+    end
+
+    always_ff @(posedge clk) begin
+        if (write)
+            memory[write_address] <= writedata;
+        data <= memory[address];
+    end
+endmodule
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Rasterize the sun and the clouds into the coverage ROM vga_ball.sv
+reads them from, in place of per-pixel circle arithmetic.
+
+    cd final/staged && python3 sky.py
+
+Every shape is a 64x64 tile of 1-bit coverage.  Tile 0 is a quarter of
+the sun, looked up by |dx|, |dy| from its centre; tile 1 + k is cloud k,
+looked up by the pixel's offset from the cloud's corner after the
+cloud_offset scroll.  The clouds are the old unions of six discs, the
+sun the old "< 1200 and > 900" or "< 900" (so d^2 == 900 stays sky).
+
+(cloud_tile.hex at the top of the tree is a sky texture with no
+transparent pixels, not a shape, so it isn't used.)
+
+Writes:
+
+  sky_mask.hex   SKY_WORDS words of 32 pixels: bit i of word w is tile
+                 address 32 * w + i, address = tile * 4096 + 64 * row + col
+  sky.svh        the sun's centre and each cloud's corner and grey,
+                 `included by vga_ball.sv
+
+A new cloud is one more line in CLOUDS, up to TILES - 1 of them.  Clouds
+have to stay inside x 0..1279 and y 0..479 at cloud_offset 0 (vga_ball.sv
+tests a pixel against a corner with 11- and 10-bit differences) and
+their tiles clear of each other: only one is looked up per pixel.
+"""
+
+import sys
+from pathlib import Path
+
+TILES = 8
+TILE = 64
+SKY_WORDS = TILES * TILE * TILE // 32
+
+SUN = (1150, 80)
+
+# (grey, disc centres at cloud_offset 0); every disc is dx^2 + dy^2 < 100
+CLOUDS = [
+    (255, [(235, 70), (245, 65), (255, 65), (245, 75), (255, 75), (265, 70)]),
+    (250, [(440, 100), (450, 95), (460, 95), (440, 105), (450, 110), (460, 105)]),
+    (245, [(690, 60), (700, 55), (710, 55), (690, 65), (700, 70), (710, 65)]),
+]
+R2 = 100
+
+
+def sun_tile():
+    def on(x, y):
+        d2 = x * x + y * y
+        return (900 < d2 < 1200) or d2 < 900
+    return [[on(col, row) for col in range(TILE)] for row in range(TILE)]
+
+
+def cloud_tile(discs):
+    """(corner x, corner y, tile) for the union of discs."""
+    x0 = min(x for x, y in discs) - 9
+    y0 = min(y for x, y in discs) - 9
+    if max(x for x, y in discs) + 9 >= x0 + TILE or max(y for x, y in discs) + 9 >= y0 + TILE:
+        sys.exit(f"cloud at {discs[0]} doesn't fit in {TILE}x{TILE}")
+    tile = [[any((x0 + col - x) ** 2 + (y0 + row - y) ** 2 < R2 for x, y in discs)
+             for col in range(TILE)] for row in range(TILE)]
+    return x0, y0, tile
+
+
+def main():
+    here = Path(__file__).resolve().parent
+
+    if len(CLOUDS) > TILES - 1:
+        sys.exit(f"{len(CLOUDS)} clouds, room for {TILES - 1}")
+    tiles = [sun_tile()]
+    corners = []
+    for grey, discs in CLOUDS:
+        x0, y0, tile = cloud_tile(discs)
+        if x0 < 0 or x0 + TILE > 1280 or y0 < 0 or y0 + TILE > 480:
+            sys.exit(f"cloud at {x0}, {y0} isn't on the screen at cloud_offset 0")
+        corners.append((x0, y0, grey))
+        tiles.append(tile)
+    tiles += [[[False] * TILE for _ in range(TILE)]] * (TILES - len(tiles))
+
+    bits = [b for tile in tiles for row in tile for b in row]
+    with (here / "sky_mask.hex").open("w") as f:
+        for w in range(0, len(bits), 32):
+            word = sum(b << i for i, b in enumerate(bits[w:w + 32]))
+            f.write(f"{word:08X}\n")
+
+    def array(width, values):
+        return "'{" + ", ".join(f"{width}'d{v}" for v in values) + "}"
+
+    with (here / "sky.svh").open("w") as f:
+        f.write("// Generated by sky.py -- do not edit.\n")
+        f.write(f"localparam int SKY_WORDS = {SKY_WORDS};\n")
+        f.write(f"localparam int SKY_BITS  = {(TILES * TILE * TILE - 1).bit_length()};\n")
+        f.write(f"localparam int CLOUDS    = {len(CLOUDS)};\n")
+        f.write(f"localparam logic [10:0] SUN_X = 11'd{SUN[0]};\n")
+        f.write(f"localparam logic [9:0]  SUN_Y = 10'd{SUN[1]};\n")
+        f.write(f"localparam logic [10:0] CLOUD_X    [CLOUDS] = {array(11, (c[0] for c in corners))};\n")
+        f.write(f"localparam logic [9:0]  CLOUD_Y    [CLOUDS] = {array(10, (c[1] for c in corners))};\n")
+        f.write(f"localparam logic [7:0]  CLOUD_GREY [CLOUDS] = {array(8, (c[2] for c in corners))};\n")
+
+    print(f"sky_mask.hex: the sun and {len(CLOUDS)} clouds, {SKY_WORDS} words")
+
+
+if __name__ == "__main__":
+    main()
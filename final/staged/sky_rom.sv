@@ -0,0 +1,30 @@
+// The sun and cloud coverage tiles (sky_mask.hex, rasterized by sky.py),
+// 1 bit a pixel, 32 pixels a word.  Two read ports: a cloud and the sun
+// can both be under the same pixel.  Inferred as dual-port block RAM in
+// ROM mode.
+module sky_rom (
+    input  logic        clk,
+    input  logic [14:0] address_a,
+    output logic        data_a,
+    input  logic [14:0] address_b,
+    output logic        data_b
+);
+
+    logic [31:0] memory [0:1023];
+    logic [31:0] word_a, word_b;
+    logic [4:0]  bit_a, bit_b;
+
+    initial begin
+        $readmemh("sky_mask.hex", memory);
+    end
+
+    always_ff @(posedge clk) begin
+        word_a <= memory[address_a[14:5]];
+        word_b <= memory[address_b[14:5]];
+        bit_a <= address_a[4:0];
+        bit_b <= address_b[4:0];
+    end
+
+    assign data_a = word_a[bit_a];
+    assign data_b = word_b[bit_b];
+endmodule
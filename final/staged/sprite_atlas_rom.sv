@@ -0,0 +1,37 @@
+// All the sprites in one ROM (sprite_atlas.hex, packed by atlas.py) as
+// 9-bit palette indices, with their mask plane (sprite_mask.hex, a word
+// per 32 pixels) alongside: mask_a says whether the pixel data_a belongs
+// to is drawn at all.  Two read ports so the object engine fetches two
+// pixels of a row a clock.  Both inferred as dual-port block RAM in ROM mode.
+module sprite_atlas_rom (
+    input  logic        clk,
+    input  logic [13:0] address_a,
+    output logic [8:0]  data_a,
+    output logic        mask_a,
+    input  logic [13:0] address_b,
+    output logic [8:0]  data_b,
+    output logic        mask_b
+);
+
+    logic [8:0]  memory [0:16383];
+    logic [31:0] mask [0:511];
+    logic [31:0] mask_word_a, mask_word_b;
+    logic [4:0]  mask_bit_a, mask_bit_b;
+
+    initial begin
+        $readmemh("sprite_atlas.hex", memory);
+        $readmemh("sprite_mask.hex", mask);
+    end
+
+    always_ff @(posedge clk) begin
+        data_a <= memory[address_a];
+        data_b <= memory[address_b];
+        mask_word_a <= mask[address_a[13:5]];
+        mask_word_b <= mask[address_b[13:5]];
+        mask_bit_a <= address_a[4:0];
+        mask_bit_b <= address_b[4:0];
+    end
+
+    assign mask_a = mask_word_a[mask_bit_a];
+    assign mask_b = mask_word_b[mask_bit_b];
+endmodule
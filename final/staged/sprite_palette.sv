@@ -0,0 +1,25 @@
+// The sprite palettes: 2048 RGB565 colours, each palette a power-of-two
+// run of them where atlas.py put it (PAL_BASE, PAL_MASK), starting out as
+// sprite_palette.hex and written from the bus.  One block RAM: a read
+// port and a write port.
+module sprite_palette (
+    input  logic        clk,
+    input  logic        write,
+    input  logic [10:0] write_address,
+    input  logic [15:0] writedata,
+    input  logic [10:0] address,
+    output logic [15:0] data
+);
+
+    logic [15:0] memory [0:2047];
+
+    initial begin
+        $readmemh("sprite_palette.hex", memory);
+    end
+
+    always_ff @(posedge clk) begin
+        if (write)
+            memory[write_address] <= writedata;
+        data <= memory[address];
+    end
+endmodule
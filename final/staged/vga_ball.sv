@@ -0,0 +1,951 @@
+// Dino Run code
+module vga_ball(
+    input  logic        clk,
+    input  logic        reset,
+input logic [31:0]  writedata,
+    input logic         write,
+    input               chipselect,
+    input logic [8:0]   address,
+    input  logic [7:0]  controller_report,
+
+    output logic [7:0]  VGA_R, VGA_G, VGA_B,
+    output logic        VGA_CLK, VGA_HS, VGA_VS, VGA_BLANK_n, VGA_SYNC_n,
+
+
+
+    input  logic        L_READY,
+input  logic        R_READY,
+output logic [15:0] L_DATA,
+output logic [15:0] R_DATA,
+output logic        L_VALID,
+output logic        R_VALID
+
+);
+
+    
+    localparam HACTIVE = 11'd1280;
+    localparam HTOTAL  = 11'd1600;
+    localparam VTOTAL  = 10'd525;
+    localparam SCORE_X = 120;
+    localparam SCORE_Y = 10;
+     logic replay_button;
+
+
+    initial begin
+    $readmemh("background.hex", audio_data);
+end
+
+   
+
+//audio sample variables
+
+logic [15:0] audio_data[0:9659];  
+logic [17:0] audio_index;
+logic [15:0] sample_clock;
+logic [15:0] audio_sample;
+
+
+
+    // VGA TIMING
+    logic [10:0] hcount;
+    logic [9:0]  vcount;
+      
+      //Score as 5-digit BCD 
+   localparam int N_DIGITS = 5;
+   logic [3:0] bcd [N_DIGITS-1:0];  // [0]=units … [4]=ten-thousands
+
+  logic [16:0]  score;
+  logic [3:0]  digit_ten_thou, digit_thou, digit_h, digit_t, digit_u;
+    logic [7:0]  font_rom [0:9][0:7];
+     // Frame Animation
+    logic [23:0] frame_counter;
+    logic [1:0]  sprite_state;
+
+    logic [10:0] cloud_offset;
+    logic [23:0] cloud_counter;
+
+    logic [7:0] sky_r, sky_g, sky_b;
+    logic [23:0] sky_counter;
+    logic [3:0]  sky_phase;
+     logic [9:0] rx;
+    logic [2:0] idx, ry;
+    logic [3:0] cx;
+
+ // Sun color
+    logic [7:0] sun_r, sun_g, sun_b; //  sun color variables
+    logic [23:0] sun_counter;
+    logic [10:0] sun_offset_x;
+    logic [9:0]  sun_offset_y;
+  
+  
+
+    initial begin
+        // simple 8×8 font for digits 0–9
+        font_rom[0] = '{8'h3C,8'h66,8'h6E,8'h7E,8'h76,8'h66,8'h3C,8'h00};
+        font_rom[1] = '{8'h18,8'h38,8'h18,8'h18,8'h18,8'h18,8'h7E,8'h00};
+        font_rom[2] = '{8'h3C,8'h66,8'h06,8'h1C,8'h30,8'h66,8'h7E,8'h00};
+        font_rom[3] = '{8'h3C,8'h66,8'h06,8'h1C,8'h06,8'h66,8'h3C,8'h00};
+        font_rom[4] = '{8'h0C,8'h1C,8'h2C,8'h4C,8'h7E,8'h0C,8'h0C,8'h00};
+        font_rom[5] = '{8'h7E,8'h60,8'h7C,8'h06,8'h06,8'h66,8'h3C,8'h00};
+        font_rom[6] = '{8'h3C,8'h66,8'h60,8'h7C,8'h66,8'h66,8'h3C,8'h00};
+        font_rom[7] = '{8'h7E,8'h06,8'h0C,8'h18,8'h30,8'h30,8'h30,8'h00};
+        font_rom[8] = '{8'h3C,8'h66,8'h66,8'h3C,8'h66,8'h66,8'h3C,8'h00};
+        font_rom[9] = '{8'h3C,8'h66,8'h66,8'h3E,8'h06,8'h66,8'h3C,8'h00};
+    end
+    localparam [7:0] FG_R = 8'h00, FG_G = 8'h00, FG_B = 8'h00;  // black digits
+
+
+    logic [7:0]  a, b, c;
+// Night Transition
+    logic [39:0] night_timer; // Timer to trigger night time
+    logic night_time; // Flag to indicate if it's nighttime
+   
+    logic [10:0] dino_x = 100, dino_y = 248;
+    logic [10:0] godzilla_x, godzilla_y;
+
+
+    logic ducking, jumping;
+
+
+    // Obstacles
+    logic [10:0] s_cac_x = 1200, s_cac_y = 248;
+    logic [10:0] group_x = 1600, group_y = 248;
+    logic [10:0] lava_x   = 1800, lava_y   = 248;
+    logic [10:0] ptr_x    = 1400, ptr_y    = 200;
+    logic [10:0] powerup_x, powerup_y;
+
+    logic [10:0] cg_x, cg_y;
+
+
+    // === Replay ===
+    logic [10:0] replay_x = 560, replay_y = 200;
+
+    // Motion 
+    logic [23:0] motion_timer;
+    logic [10:0] obstacle_speed = 1;
+    logic [4:0]  passed_count;
+    logic        game_over;
+   // logic [1:0]  sprite_state;
+
+  // Power-up (Godzilla mode)
+logic godzilla_mode;
+
+    logic [39:0] godzilla_timer;
+  //lfsr logic for random offset (obstacle positions)
+    logic [5:0] lfsr;
+    always_ff @(posedge clk or posedge reset) begin
+        if (reset) begin
+            lfsr <= 6'b101011; // non‐zero seed
+        end else if (!game_over && motion_timer >= 24'd2_000_000) begin
+            // x^6 + x^5 + 1 polynomial
+            lfsr <= { lfsr[4:0], lfsr[5] ^ lfsr[4] };
+        end
+    end
+
+    function automatic logic collide(
+        input logic [10:0] ax, ay, bx, by,
+        input logic [5:0]  aw, ah, bw, bh
+    );
+        return ((ax < bx + bw) && (ax + aw > bx) &&
+                (ay < by + bh) && (ay + ah > by));
+    endfunction
+
+    always_ff @(posedge clk or posedge reset) begin
+        if (reset) begin
+            s_cac_x        <= 1200;
+            group_x        <= 1600;
+            lava_x         <= 1800;
+            ptr_x          <= 1400;
+            obstacle_speed <= 1;
+            passed_count   <= 0;
+            game_over      <= 0;
+            sprite_state   <= 0;
+            motion_timer   <= 0;
+            score          <= 0;
+            frame_counter <= 0;
+             
+            cloud_counter <= 0;
+            cloud_offset <= 0;
+            sky_counter <= 0;
+            sky_phase <= 0;
+            sky_r <= 8'd135;
+            sky_g <= 8'd206;
+            sky_b <= 8'd235;
+            sun_counter <= 0;
+            sun_offset_x <= 0;
+            sun_offset_y <= 0;
+            night_timer <= 32'd0;
+            night_time <= 0; // Start with day
+            sky_r <= 8'd135;
+            sky_g <= 8'd206;
+            sky_b <= 8'd235; // Day sky color
+            
+            
+
+            score <= 17'd0;
+            // Power-up reset
+            powerup_x      <= 800;
+            powerup_y      <= 248;
+            godzilla_mode  <= 0;
+            godzilla_timer <= 0;
+
+        end else if (chipselect && write) begin
+            case (address)
+                9'd0: dino_x <= writedata[9:0];
+                9'd1: dino_y <= writedata[9:0];
+           
+                9'd13: ducking <= writedata[0];
+                9'd14: jumping <= writedata[0];
+               
+                9'd17: lava_x <= writedata[9:0];   
+                9'd18: lava_y <= writedata[9:0];
+                9'd19: replay_button <= writedata[0]; // trigger replay
+
+            endcase
+
+        end else if (!game_over) begin
+            if (motion_timer >= 24'd2_000_000) begin
+                // wrap each obstacle with a different pseudo‐random offset
+                s_cac_x <= (s_cac_x <= obstacle_speed)
+                           ? (HACTIVE + {lfsr,       4'd0})
+                           : s_cac_x - obstacle_speed;
+                group_x <= (group_x <= obstacle_speed)
+                           ? (HACTIVE + {lfsr ^ 6'h3F,4'd0})
+                           : group_x - obstacle_speed;
+                lava_x  <= (lava_x  <= obstacle_speed)
+                           ? (HACTIVE + {{lfsr[3:0]},6'd0})
+                           : lava_x  - obstacle_speed;
+                ptr_x   <= (ptr_x   <= obstacle_speed)
+                           ? (HACTIVE + {{lfsr[5:2]},6'd0})
+                           : ptr_x   - obstacle_speed;
+                // Power-up movement
+powerup_x <= (powerup_x <= obstacle_speed)
+             ? (HACTIVE + {{lfsr[4:0]}, 5'd0})
+             : powerup_x - obstacle_speed;
+
+                  bcd[0] <= bcd[0] + 1;
+               for (int i = 0; i < N_DIGITS-1; i++) begin
+                 if (bcd[i] == 4'd10) begin
+                   bcd[i]   <= 4'd0;
+                   bcd[i+1] <= bcd[i+1] + 1;
+                 end
+               end
+               // wrap highest digit
+               if (bcd[N_DIGITS-1] == 4'd10)
+                 bcd[N_DIGITS-1] <= 4'd0;
+                // tick the score (wrap from 999 back to 0)
+score <= (score == 17'd99999) ? 17'd0 : score + 1;                // count passes and speed up
+                if (s_cac_x <= obstacle_speed || group_x <= obstacle_speed ||
+                    lava_x  <= obstacle_speed || ptr_x   <= obstacle_speed) begin
+                    passed_count <= passed_count + 1;
+                end
+                if (passed_count >= 12) begin
+                    obstacle_speed <= obstacle_speed + 1;
+                    passed_count   <= 0;
+                end
+
+                motion_timer <= 0;
+                sprite_state <= sprite_state + 1;
+            end else begin
+                motion_timer <= motion_timer + 1;
+            end
+
+            if (!godzilla_mode &&(collide(dino_x, dino_y, s_cac_x,  s_cac_y,  32,32,32,32) ||
+                collide(dino_x, dino_y, group_x,  group_y, 64,32,32,32) ||
+                collide(dino_x, dino_y, lava_x,   lava_y,   32,32,32,32) ||
+                                  collide(dino_x, dino_y, ptr_x,    ptr_y,    32,32,32,32))) begin
+                game_over <= 1;
+
+                
+            end
+
+            if (frame_counter == 24'd5_000_000) begin
+                sprite_state <= sprite_state + 1;
+               
+                frame_counter <= 0;
+            end else begin
+                frame_counter <= frame_counter + 1;
+            end
+
+            // Cloud drifting
+            if (cloud_counter == 24'd8_000_000) begin
+                cloud_counter <= 0;
+                cloud_offset <= cloud_offset + 1;
+                if (cloud_offset > 1280) cloud_offset <= 0;
+            end else begin
+                cloud_counter <= cloud_counter + 1;
+            end
+
+
+       
+          
+         // Night Timer Logic 
+            if (night_timer < 40'd1_500_000_000) begin
+            night_timer <= night_timer + 1;  // Increment the timer
+         end else if (night_timer == 40'd1_500_000_000) begin
+            night_time <= ~night_time;
+             night_timer <= 32'd0;
+         end
+            if (night_time) begin
+                sky_r <= 8'd10;  // Dark blue night sky
+                sky_g <= 8'd10;
+                sky_b <= 8'd40;
+             
+            sun_r <= 8'd255; // White moon
+            sun_g <= 8'd255;
+            sun_b <= 8'd255;
+            end else begin
+                sky_r <= 8'd135;
+                sky_g <= 8'd206;
+                sky_b <= 8'd235; // Day sky color
+                sun_r <= 8'd255; // Yellow sun
+                sun_g <= 8'd255;
+                sun_b <= 8'd0;
+            end
+     
+            if (collide(dino_x, dino_y, powerup_x, powerup_y, 32, 32, 32, 32)) begin
+    godzilla_mode <= 1;
+    godzilla_timer <= 0;
+    powerup_x <= 2000; // move off screen
+end
+            //Godzilla destroys 
+if (godzilla_mode) begin
+    if (collide(dino_x, dino_y, s_cac_x, s_cac_y, 32, 32, 32, 32))
+        s_cac_x <= 2000;
+    if (collide(dino_x, dino_y, group_x, group_y, 64, 32, 32, 32))
+        group_x <= 2000;
+    if (collide(dino_x, dino_y, lava_x, lava_y, 32, 32, 32, 32))
+        lava_x <= 2000;
+    if (collide(dino_x, dino_y, ptr_x, ptr_y, 32, 32, 32, 32))
+        ptr_x <= 2000;
+end
+
+
+
+
+
+//Godzilla timeout
+if (godzilla_mode)
+    godzilla_timer <= godzilla_timer + 1;
+
+if (godzilla_timer >= 32'd100_000_000_000) begin
+    godzilla_mode <= 0;
+    godzilla_timer <= 0;
+end
+        end else begin
+            // on replay, reset everything
+             if (replay_button) begin
+                s_cac_x        <= 1200;
+                group_x        <= 1600;
+                lava_x         <= 1800;
+                ptr_x          <= 1400;
+                obstacle_speed <= 1;
+                passed_count   <= 0;
+                game_over      <= 0;
+                score          <= 0;
+                motion_timer   <= 0;
+                godzilla_mode  <= 0;
+                godzilla_timer <= 0;
+                powerup_x      <= 800;
+                powerup_y      <= 248;
+                for (int i = 0; i < N_DIGITS; i++) begin
+                bcd[i] <= 4'd0;
+                end
+              
+
+            end
+        end
+    end
+
+    // VGA COUNTERS
+    vga_counters counters(
+        .clk50     (clk),
+        .reset     (reset),
+        .hcount    (hcount),
+        .vcount    (vcount),
+        .VGA_CLK   (VGA_CLK),
+        .VGA_HS    (VGA_HS),
+        .VGA_VS    (VGA_VS),
+        .VGA_BLANK_n(VGA_BLANK_n),
+        .VGA_SYNC_n(VGA_SYNC_n)
+    );
+
+    // SPRITES
+    // Every sprite is in one ROM, sprite_atlas.hex, as 9-bit indices into
+    // its own palette, which has all of its colours, with a 1-bit mask
+    // plane saying which of its pixels are drawn; atlas.py puts the
+    // offsets, widths and palette numbers in sprite_atlas.svh.  A sprite's
+    // id is its palette number.  Sprites are 32 rows.  The palettes share
+    // one 2048-word RAM, palette p's colour i at PAL_BASE[p] | (i &
+    // PAL_MASK[p]).  From the bus, address 256 sets the RAM address and a
+    // write to 257 sets the colour there (RGB565) and steps to the next.
+    //
+    // An object engine draws each line into one of two line buffers while
+    // the other is on screen.  Objects 0-6 are the game's own (replay
+    // banner, pterodactyl, lava, cactus group, small cactus, dino,
+    // powerup), taken from its registers at priority 4; objects 7-70 are
+    // the object attribute table (OAM), two bus words an entry at
+    // 128 + 2 * entry:
+    //
+    //   word 0   [10:0] x, [25:16] y
+    //   word 1   [3:0] sprite id, [7:4] palette, [8] flip (mirrored),
+    //            [11:9] priority, [15] enable
+    //
+    // Over a line the engine takes the objects in order, two clocks each
+    // (fetch, test against the next line), and copies a covering one's row
+    // into the buffer two pixels a clock through the atlas's two ports.
+    // An opaque pixel goes over an empty one or one with a higher priority
+    // number: a lower number is in front, and on a tie the lower object
+    // wins.  Pixels not issued by clock HTOTAL - 3 of the line aren't drawn.
+    //
+    // The screen side reads the other buffer three clocks ahead of the
+    // counters (address register, line buffer, palette RAM) and clears
+    // each pixel after reading it, so the buffer comes back empty.
+`include "sprite_atlas.svh"
+
+    localparam int GAME_OBJECTS = 7;
+    localparam int OAM_ENTRIES  = 64;
+    localparam int N_OBJECTS    = GAME_OBJECTS + OAM_ENTRIES;
+    localparam int SPRITE_H     = 32;
+    localparam logic [2:0] GAME_PRIORITY = 3'd4;
+
+    localparam logic [1:0] ENG_FETCH = 2'd0, ENG_TEST = 2'd1, ENG_DRAW = 2'd2, ENG_DONE = 2'd3;
+
+    logic [10:0] hn;                        // hcount, vcount three clocks on
+    logic [9:0]  vn;
+
+    // the game's objects
+    logic [10:0] game_x [GAME_OBJECTS];
+    logic [10:0] game_y [GAME_OBJECTS];
+    logic [3:0]  game_id [GAME_OBJECTS];
+    logic        game_on [GAME_OBJECTS];
+    logic        game_flip [GAME_OBJECTS];
+    logic [3:0]  dino_id, ptr_id;
+
+    // the OAM
+    logic [25:0] oam_pos [0:OAM_ENTRIES-1];
+    logic [15:0] oam_attr [0:OAM_ENTRIES-1];
+    logic [25:0] oam_pos_q;
+    logic [15:0] oam_attr_q;
+
+    // the engine: the object being fetched or tested, then the row being drawn
+    logic [1:0]  eng;
+    logic [6:0]  obj;
+    logic [9:0]  eng_line;                  // the line it is drawing
+    logic        lb_sel;                    // the buffer on screen
+    logic [10:0] g_x, g_y;
+    logic [3:0]  g_id;
+    logic        g_on, g_flip;
+    logic [10:0] t_x, t_y;
+    logic [3:0]  t_id, t_pal;
+    logic [2:0]  t_prio;
+    logic        t_on, t_flip, t_hit;
+    logic [10:0] d_x;
+    logic [7:0]  d_col, d_w;
+    logic [13:0] d_base, d_wrap, d_row;
+    logic [PAL_BITS-1:0]   d_pal_base;
+    logic [INDEX_BITS-1:0] d_pal_mask;
+    logic [2:0]  d_prio;
+    logic        d_flip;
+
+    // a pixel pair on its way: issued (atlas address, x), then with the
+    // atlas and the line buffer read
+    logic [7:0]  col_a, col_b;
+    logic [11:0] x_a, x_b;
+    logic [13:0] atlas_addr_a, atlas_addr_b;
+    logic [INDEX_BITS-1:0] atlas_data_a, atlas_data_b;
+    logic        mask_a, mask_b;
+    logic [10:0] iss_x_a, iss_x_b, wr_x_a, wr_x_b;
+    logic        iss_ok_a, iss_ok_b, wr_ok_a, wr_ok_b;
+    logic [PAL_BITS-1:0]   iss_pal_base, wr_pal_base;
+    logic [INDEX_BITS-1:0] iss_pal_mask, wr_pal_mask;
+    logic [2:0]  iss_prio, wr_prio;
+    logic [14:0] old_a, old_b;
+    logic        put_a, put_b;
+
+    // the line buffers, [buffer][bank], bank = x[0]: {valid, priority,
+    // palette RAM address}
+    logic        lb_write [2][2];
+    logic [9:0]  lb_write_address [2][2];
+    logic [14:0] lb_writedata [2][2];
+    logic [9:0]  lb_address [2][2];
+    logic [14:0] lb_data [2][2];
+
+    // the screen side
+    logic [10:0] disp_x, disp_x2;
+    logic        disp_buf, disp_buf2;
+    logic [14:0] disp_px;
+    logic [PAL_BITS-1:0] color_addr;
+    logic        shown, sprite_on;
+    logic [15:0] sprite_px;
+
+    // the bus's palette RAM address
+    logic [PAL_BITS-1:0] pal_ptr;
+    logic        pal_write;
+
+    sprite_atlas_rom atlas(.clk(clk),
+                           .address_a(atlas_addr_a), .data_a(atlas_data_a), .mask_a(mask_a),
+                           .address_b(atlas_addr_b), .data_b(atlas_data_b), .mask_b(mask_b));
+
+    assign pal_write = chipselect && write && address == 9'd257;
+
+    sprite_palette palette(.clk(clk),
+                           .write(pal_write),
+                           .write_address(pal_ptr), .writedata(writedata[15:0]),
+                           .address(color_addr), .data(sprite_px));
+
+    for (genvar i = 0; i < 2; i++) begin : lb_buffer
+        for (genvar k = 0; k < 2; k++) begin : lb_bank
+            line_buffer lb(.clk(clk),
+                           .write(lb_write[i][k]), .write_address(lb_write_address[i][k]),
+                           .writedata(lb_writedata[i][k]),
+                           .address(lb_address[i][k]), .data(lb_data[i][k]));
+        end
+    end
+
+    always_ff @(posedge clk) begin
+        if (chipselect && write && address[8:7] == 2'b01) begin
+            if (address[0]) oam_attr[address[6:1]] <= writedata[15:0];
+            else            oam_pos[address[6:1]]  <= writedata[25:0];
+        end
+        oam_pos_q  <= oam_pos[6'(obj - GAME_OBJECTS)];
+        oam_attr_q <= oam_attr[6'(obj - GAME_OBJECTS)];
+
+        if (chipselect && write && address == 9'd256) pal_ptr <= writedata[PAL_BITS-1:0];
+        else if (pal_write)                           pal_ptr <= pal_ptr + 1'd1;
+    end
+
+    initial begin
+        for (int i = 0; i < OAM_ENTRIES; i++) begin
+            oam_pos[i]  = 26'd0;
+            oam_attr[i] = 16'd0;
+        end
+        pal_ptr = '0;
+    end
+
+    always_comb begin
+        if (godzilla_mode)          dino_id = PAL_GODZILLA;
+        else if (ducking)           dino_id = PAL_DUCK;
+        else if (jumping)           dino_id = PAL_JUMP;
+        else if (sprite_state == 1) dino_id = PAL_LEFT_LEG;
+        else if (sprite_state == 2) dino_id = PAL_RIGHT_LEG;
+        else                        dino_id = PAL_DINO;
+
+        // Pterodactyl animation
+        ptr_id = (sprite_state == 1) ? PAL_PTR_UP : PAL_PTR_DOWN;
+
+        game_x[0] = replay_x;  game_y[0] = replay_y;  game_id[0] = PAL_REPLAY;
+        game_x[1] = ptr_x;     game_y[1] = ptr_y;     game_id[1] = ptr_id;
+        game_x[2] = lava_x;    game_y[2] = lava_y;    game_id[2] = PAL_LAVA;
+        game_x[3] = group_x;   game_y[3] = group_y;   game_id[3] = PAL_GROUP;
+        game_x[4] = s_cac_x;   game_y[4] = s_cac_y;   game_id[4] = PAL_S_CAC;
+        game_x[5] = dino_x;    game_y[5] = dino_y;    game_id[5] = dino_id;
+        game_x[6] = powerup_x; game_y[6] = powerup_y; game_id[6] = PAL_POWERUP;
+        for (int i = 0; i < GAME_OBJECTS; i++) begin
+            game_on[i]   = (i == 0) ? game_over : !game_over;
+            game_flip[i] = (i == 1);
+        end
+    end
+
+    always_comb begin
+        hn = (hcount >= HTOTAL - 3) ? hcount - (HTOTAL - 3) : hcount + 3;
+        if (hcount < HTOTAL - 3) vn = vcount;
+        else                     vn = (vcount == VTOTAL - 1) ? 10'd0 : vcount + 1;
+
+        // the object under test: the game's or the OAM's
+        if (obj < GAME_OBJECTS) begin
+            t_x = g_x;  t_y = g_y;  t_id = g_id;  t_pal = g_id;
+            t_on = g_on;  t_flip = g_flip;  t_prio = GAME_PRIORITY;
+        end else begin
+            t_x = oam_pos_q[10:0];  t_y = 11'(oam_pos_q[25:16]);
+            t_id = oam_attr_q[3:0];  t_pal = oam_attr_q[7:4];
+            t_on = oam_attr_q[15];  t_flip = oam_attr_q[8];  t_prio = oam_attr_q[11:9];
+        end
+        t_hit = t_on && t_id < SPRITE_IDS && eng_line >= t_y && eng_line < t_y + SPRITE_H;
+
+        // the pair of pixels at columns d_col, d_col + 1 of the row
+        col_a = d_flip ? d_w - 8'd1 - d_col : d_col;
+        col_b = d_flip ? d_w - 8'd2 - d_col : d_col + 8'd1;
+        x_a   = d_x + d_col;
+        x_b   = x_a + 12'd1;
+    end
+
+    always_ff @(posedge clk) begin
+        if (hn == HTOTAL - 1) begin
+            // a new line: the engine's buffer goes on screen
+            lb_sel   <= !lb_sel;
+            eng      <= ENG_FETCH;
+            obj      <= 0;
+            eng_line <= (vn >= VTOTAL - 2) ? vn - (VTOTAL - 2) : vn + 2;
+        end else begin
+            case (eng)
+            ENG_FETCH: begin
+                g_x    <= game_x[obj[2:0]];
+                g_y    <= game_y[obj[2:0]];
+                g_id   <= game_id[obj[2:0]];
+                g_on   <= game_on[obj[2:0]];
+                g_flip <= game_flip[obj[2:0]];
+                eng    <= ENG_TEST;
+            end
+            ENG_TEST: begin
+                d_x    <= t_x;
+                d_col  <= 0;
+                d_w    <= SPRITE_WIDTH[t_id];
+                d_base <= SPRITE_BASE[t_id];
+                d_wrap <= SPRITE_WRAP[t_id];
+                d_row  <= 14'((eng_line - t_y) * SPRITE_WIDTH[t_id]);
+                d_pal_base <= PAL_BASE[t_pal];
+                d_pal_mask <= PAL_MASK[t_pal];
+                d_prio <= t_prio;
+                d_flip <= t_flip;
+                if (t_hit)                    eng <= ENG_DRAW;
+                else if (obj == N_OBJECTS - 1) eng <= ENG_DONE;
+                else begin
+                    obj <= obj + 1;
+                    eng <= ENG_FETCH;
+                end
+            end
+            ENG_DRAW: begin
+                d_col <= d_col + 8'd2;
+                if (d_col + 8'd2 < d_w)        eng <= ENG_DRAW;
+                else if (obj == N_OBJECTS - 1) eng <= ENG_DONE;
+                else begin
+                    obj <= obj + 1;
+                    eng <= ENG_FETCH;
+                end
+            end
+            default: ;
+            endcase
+        end
+
+        // issue: the atlas reads the pair, the line buffer what's under it
+        atlas_addr_a <= d_base + ((d_row + 14'(col_a)) & d_wrap);
+        atlas_addr_b <= d_base + ((d_row + 14'(col_b)) & d_wrap);
+        iss_x_a  <= x_a[10:0];
+        iss_x_b  <= x_b[10:0];
+        iss_ok_a <= eng == ENG_DRAW && hn < HTOTAL - 2 && x_a < HACTIVE;
+        iss_ok_b <= eng == ENG_DRAW && hn < HTOTAL - 2 && x_b < HACTIVE;
+        iss_pal_base <= d_pal_base;
+        iss_pal_mask <= d_pal_mask;
+        iss_prio <= d_prio;
+
+        wr_x_a  <= iss_x_a;
+        wr_x_b  <= iss_x_b;
+        wr_ok_a <= iss_ok_a;
+        wr_ok_b <= iss_ok_b;
+        wr_pal_base <= iss_pal_base;
+        wr_pal_mask <= iss_pal_mask;
+        wr_prio <= iss_prio;
+
+        // the screen side
+        disp_x    <= hn;
+        disp_buf  <= lb_sel;
+        disp_x2   <= disp_x;
+        disp_buf2 <= disp_buf;
+        sprite_on <= shown;
+    end
+
+    always_comb begin
+        // the pair's writes into the engine's buffer, over empty pixels or
+        // ones further back.  lb_data and atlas_data are the pair's two
+        // clocks after issue, as wr_x_* are.  A pair's x never comes back
+        // within an object, and the next object's first pair is issued
+        // three clocks after the last one (fetch, test), so its read sees
+        // this write.  The last pair is written with hn at HTOTAL - 1,
+        // before lb_sel flips; for the two clocks after the flip the
+        // screen side is still clearing the old buffer past HACTIVE, and
+        // the engine's first write is three clocks after that.
+        old_a = lb_data[!lb_sel][wr_x_a[0]];
+        old_b = lb_data[!lb_sel][wr_x_b[0]];
+        put_a = wr_ok_a && mask_a && (!old_a[14] || wr_prio < old_a[13:11]);
+        put_b = wr_ok_b && mask_b && (!old_b[14] || wr_prio < old_b[13:11]);
+
+        disp_px    = lb_data[disp_buf2][disp_x2[0]];
+        shown      = disp_px[14];
+        color_addr = disp_px[10:0];
+
+        for (int i = 0; i < 2; i++)
+            for (int k = 0; k < 2; k++) begin
+                // reads: the screen's pixel, or what's under the pair
+                if (i == disp_buf)            lb_address[i][k] = disp_x[10:1];
+                else if (iss_x_a[0] == k)     lb_address[i][k] = iss_x_a[10:1];
+                else                          lb_address[i][k] = iss_x_b[10:1];
+
+                // writes: clearing what the screen has read, or the pair
+                if (i == disp_buf2 && disp_x2[0] == k) begin
+                    lb_write[i][k]         = 1;
+                    lb_write_address[i][k] = disp_x2[10:1];
+                    lb_writedata[i][k]     = 15'd0;
+                end else if (wr_x_a[0] == k) begin
+                    lb_write[i][k]         = put_a && i != lb_sel;
+                    lb_write_address[i][k] = wr_x_a[10:1];
+                    lb_writedata[i][k]     = {1'b1, wr_prio,
+                                              wr_pal_base | PAL_BITS'(atlas_data_a & wr_pal_mask)};
+                end else begin
+                    lb_write[i][k]         = put_b && i != lb_sel;
+                    lb_write_address[i][k] = wr_x_b[10:1];
+                    lb_writedata[i][k]     = {1'b1, wr_prio,
+                                              wr_pal_base | PAL_BITS'(atlas_data_b & wr_pal_mask)};
+                end
+            end
+    end
+
+    // SKY
+    // The sun and the clouds are 64x64 tiles of 1-bit coverage in one ROM,
+    // sky_mask.hex; sky.py draws them and puts the sun's centre and the
+    // clouds' corners and greys in sky.svh.  Same three clocks ahead as
+    // the sprites (address register, ROM, flag register).  The clouds
+    // scroll by cloud_offset and wrap at 1280, and only one cloud's tile
+    // is ever under a pixel; the sun's tile is a quarter of it, looked up
+    // by |dx| and |dy|.
+`include "sky.svh"
+
+    logic [10:0] sky_u, cloud_du, sun_cx, sun_dx;
+    logic [9:0]  cloud_dv, sun_cy, sun_dy;
+    logic [14:0] cloud_addr, sun_addr, next_cloud_addr, next_sun_addr;
+    logic        cloud_bit, sun_bit;
+    logic        next_cloud_hit, next_sun_hit, cloud_hit1, cloud_hit2, sun_hit1, sun_hit2;
+    logic [7:0]  next_grey, grey1, grey2, cloud_grey;
+    logic        cloud_on, sun_on;
+
+    sky_rom sky(.clk(clk),
+                .address_a(cloud_addr), .data_a(cloud_bit),
+                .address_b(sun_addr), .data_b(sun_bit));
+
+    always_comb begin
+        // where hn is in the sky as it was at cloud_offset 0
+        sky_u = (hn >= cloud_offset) ? hn - cloud_offset : hn + 11'd1280 - cloud_offset;
+
+        next_cloud_hit  = 0;
+        next_cloud_addr = cloud_addr;
+        next_grey       = grey1;
+        cloud_du        = '0;
+        cloud_dv        = '0;
+        // the differences wrap at 11 and 10 bits: left of or above a
+        // cloud's corner they come out at 832 and 544 or more (corners
+        // are at most 1216 and under 480), never under 64
+        for (int k = 0; k < CLOUDS; k++) begin
+            cloud_du = sky_u - CLOUD_X[k];
+            cloud_dv = vn - CLOUD_Y[k];
+            if (cloud_du < 11'd64 && cloud_dv < 10'd64) begin
+                next_cloud_hit  = 1;
+                next_cloud_addr = {3'(k + 1), cloud_dv[5:0], cloud_du[5:0]};
+                next_grey       = CLOUD_GREY[k];
+            end
+        end
+
+        sun_cx = SUN_X - sun_offset_x;
+        sun_cy = SUN_Y + sun_offset_y;
+        sun_dx = (hn >= sun_cx) ? hn - sun_cx : sun_cx - hn;
+        sun_dy = (vn >= sun_cy) ? vn - sun_cy : sun_cy - vn;
+        next_sun_hit  = sun_dx < 11'd64 && sun_dy < 10'd64;
+        next_sun_addr = {3'd0, sun_dy[5:0], sun_dx[5:0]};
+    end
+
+    // hn's lookup: clock 1 the tile address and hit flag, clock 2 the
+    // ROM's word (cloud_bit, sun_bit) beside the flag, clock 3 on, when
+    // hcount has caught up with it
+    always_ff @(posedge clk) begin
+        cloud_addr <= next_cloud_addr;
+        sun_addr   <= next_sun_addr;
+        grey1 <= next_grey;
+        grey2 <= grey1;
+        cloud_hit1 <= next_cloud_hit;
+        cloud_hit2 <= cloud_hit1;
+        sun_hit1 <= next_sun_hit;
+        sun_hit2 <= sun_hit1;
+        cloud_on <= cloud_hit2 && cloud_bit;
+        sun_on   <= sun_hit2 && sun_bit;
+        cloud_grey <= grey2;
+    end
+
+
+
+   
+always_ff @(posedge clk) begin
+    a <= 8'd135; b <= 8'd206; c <= 8'd235;
+
+    if (sample_clock >= 285) begin  // 50MHz / 175550 ≈ 285
+    sample_clock <= 0;
+    audio_sample <= audio_data[audio_index];
+
+    if (audio_index == 9659)
+        audio_index <= 0;
+    else
+        audio_index <= audio_index + 1;
+end else begin
+    sample_clock <= sample_clock + 1;
+end
+
+if (L_READY) begin
+    L_DATA  <= audio_sample;
+    L_VALID <= (sample_clock == 0);
+end else begin
+    L_VALID <= 0;
+end
+
+if (R_READY) begin
+    R_DATA  <= audio_sample;
+    R_VALID <= (sample_clock == 0);
+end else begin
+    R_VALID <= 0;
+end
+
+
+
+
+
+    if (!game_over ) begin
+//begin
+     
+   
+
+    if (vcount < 280) begin
+        a <= sky_r;
+        b <= sky_g;
+        c <= sky_b;
+    end else if (vcount > 300) begin
+        a <= 8'd100; 
+        b <= 8'd40;
+        c <= 8'd10;
+    end else begin
+        a <= 8'd139; 
+        b <= 8'd69;
+        c <= 8'd19;
+        
+    end
+
+    //Ground Line 
+    if (vcount == 280) begin
+        a <= 8'd0;
+        b <= 8'd0;
+        c <= 8'd0;
+    end
+
+    
+    // Sun / moon (sky_rom)
+    if (sun_on) begin
+        a <= sun_r;
+        b <= sun_g;
+        c <= sun_b;
+    end
+
+    // Clouds (sky_rom)
+    if (cloud_on) begin
+        a <= cloud_grey;
+        b <= cloud_grey;
+        c <= cloud_grey;
+    end
+
+    // Tiny Birds
+    if (((hcount > 300 && hcount < 305) && (vcount == 50)) ||
+        ((hcount > 305 && hcount < 310) && (vcount == 51)) ||
+        ((hcount > 310 && hcount < 315) && (vcount == 50)) ||
+        ((hcount > 600 && hcount < 605) && (vcount == 80)) ||
+        ((hcount > 605 && hcount < 610) && (vcount == 81)) ||
+        ((hcount > 610 && hcount < 615) && (vcount == 80))) begin
+        a <= 8'd0;
+        b <= 8'd0;
+        c <= 8'd0;
+    end
+         //  Ground Rocks 
+    if (vcount > 280 && vcount < 480) begin
+        if ((hcount % 120 == 0 && vcount % 50 < 10) ||
+            (hcount % 200 == 15 && vcount % 60 < 8)) begin
+            a <= 8'd110;
+            b <= 8'd50;
+            c <= 8'd10;
+        end
+    end
+
+        
+        // Sprites, from the line buffers above
+        if (sprite_on) begin
+            a <= {sprite_px[15:11], 3'b000};
+            b <= {sprite_px[10:5],  2'b00};
+            c <= {sprite_px[4:0],   3'b000};
+        end
+    
+      if (vcount >= SCORE_Y && vcount < SCORE_Y + 8) begin
+    if (hcount >= SCORE_X && hcount < (SCORE_X + N_DIGITS * 8)) begin
+        rx  = hcount - SCORE_X;
+        idx = rx / 8;          // Each digit is 8 pixels wide
+        cx  = rx % 8;
+        ry  = vcount - SCORE_Y;
+
+        if (idx < N_DIGITS && cx < 8) begin
+            if (font_rom[bcd[N_DIGITS - 1 - idx]][ry][7 - cx]) begin
+                a <= FG_R;
+                b <= FG_G;
+                c <= FG_B;
+            end
+        end
+    end
+end
+
+
+    end else begin
+        // the replay banner, and whatever the OAM holds
+        if (sprite_on) begin
+            a <= {sprite_px[15:11], 3'b000};
+            b <= {sprite_px[10:5],  2'b00};
+            c <= {sprite_px[4:0],   3'b000};
+        end
+         
+    end
+    
+end
+
+assign {VGA_R, VGA_G, VGA_B} = {a, b, c};
+
+endmodule
+
+ module vga_counters(
+    input  logic        clk50, reset,
+    output logic [10:0] hcount,
+    output logic [9:0]  vcount,
+    output logic        VGA_CLK, VGA_HS, VGA_VS, VGA_BLANK_n, VGA_SYNC_n
+);
+
+   parameter HACTIVE = 11'd1280,
+             HFRONT = 11'd32,
+             HSYNC  = 11'd192,
+             HBACK  = 11'd96,
+             HTOTAL = HACTIVE + HFRONT + HSYNC + HBACK;
+
+   parameter VACTIVE = 10'd480,
+             VFRONT = 10'd10,
+             VSYNC  = 10'd2,
+             VBACK  = 10'd33,
+             VTOTAL = VACTIVE + VFRONT + VSYNC + VBACK;
+
+   logic endOfLine;
+   always_ff @(posedge clk50 or posedge reset)
+      if (reset)
+         hcount <= 0;
+      else if (endOfLine)
+         hcount <= 0;
+      else
+         hcount <= hcount + 1;
+
+   assign endOfLine = (hcount == HTOTAL - 1);
+
+   logic endOfField;
+   always_ff @(posedge clk50 or posedge reset)
+      if (reset)
+         vcount <= 0;
+      else if (endOfLine)
+         if (endOfField)
+            vcount <= 0;
+         else
+            vcount <= vcount + 1;
+
+   assign endOfField = (vcount == VTOTAL - 1);
+
+   assign VGA_HS = !((hcount >= (HACTIVE + HFRONT)) && (hcount < (HACTIVE + HFRONT + HSYNC)));
+   assign VGA_VS = !((vcount >= (VACTIVE + VFRONT)) && (vcount < (VACTIVE + VFRONT + VSYNC)));
+   assign VGA_SYNC_n = 1'b0;
+   assign VGA_BLANK_n = (hcount < HACTIVE) && (vcount < VACTIVE);
+   assign VGA_CLK = hcount[0];
+
+   endmodule
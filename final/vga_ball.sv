@@ -71,6 +71,9 @@ logic [15:0] audio_sample;
 
  // Sun color
     logic [7:0] sun_r, sun_g, sun_b; //  sun color variables
+    logic [23:0] sun_counter;
+    logic [10:0] sun_offset_x;
+    logic [9:0]  sun_offset_y;
   
   
 
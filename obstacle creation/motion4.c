@@ -2,15 +2,14 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <fcntl.h>
 #include <unistd.h>
-#include <sys/mman.h>
+#include <stdlib.h>
+#include "../controller/regbus.h"
+#include "../controller/shadow_regs.h"
+#include "../controller/tick.h"
 
-// ------------------------------------------------------------------
-//  HPS→FPGA lightweight bridge (LW) base and span
-// ------------------------------------------------------------------
-#define LW_BRIDGE_BASE 0xFF200000UL
-#define LW_BRIDGE_SPAN 0x00001000UL
+// gcc -O2 -std=gnu99 -o motion4 motion4.c ../controller/regbus.c ../controller/shadow_regs.c ../controller/tick.c
+// DINO_BUS=sim:secs=60 needs -DDINO_COSIM ../controller/regbus_sim.c ../sim/dino_sim.c
 
 // PIO offsets (in bytes) from LW_BRIDGE_BASE
 #define OFF_DINO_X    (0x00)
@@ -42,66 +41,65 @@ static bool overlap(int ax,int ay,int aw,int ah,
 }
 
 int main() {
-    int    fd = open("/dev/mem", O_RDWR|O_SYNC);
-    if (fd < 0) { perror("open /dev/mem"); return 1; }
-
-    void *lw_base = mmap(NULL, LW_BRIDGE_SPAN, PROT_READ|PROT_WRITE,
-                         MAP_SHARED, fd, LW_BRIDGE_BASE);
-    if (lw_base == MAP_FAILED) { perror("mmap"); return 1; }
+    // DINO_BUS picks the backend (devmem, shm:<path>, model)
+    struct regbus *bus = regbus_open(getenv("DINO_BUS"));
+    if (!bus) return 1;
 
-    volatile uint32_t *pio = (volatile uint32_t *)lw_base;
-
-    // PIO register pointers
-    volatile uint32_t *r_dino_x  = pio + (OFF_DINO_X/4);
-    volatile uint32_t *r_dino_y  = pio + (OFF_DINO_Y/4);
-    volatile uint32_t *r_cg_x    = pio + (OFF_CG_X/4);
-    volatile uint32_t *r_cg_y    = pio + (OFF_CG_Y/4);
-    volatile uint32_t *r_lava_x  = pio + (OFF_LAVA_X/4);
-    volatile uint32_t *r_lava_y  = pio + (OFF_LAVA_Y/4);
-    volatile uint32_t *r_keys    = pio + (OFF_KEYS/4);
+    // Position registers live in a shadow copy; only the key PIO is
+    // read from the bus each frame.
+    struct shadow_regs regs;
+    shadow_init(&regs, bus);
 
     // initialize to match your Verilog reset
-    *r_dino_x = 100;  *r_dino_y = 248;
-    *r_cg_x   = 400;  *r_cg_y   = 248;
-    *r_lava_x = 600;  *r_lava_y = 248;
+    shadow_set(&regs, OFF_DINO_X, 100);  shadow_set(&regs, OFF_DINO_Y, 248);
+    shadow_set(&regs, OFF_CG_X,   400);  shadow_set(&regs, OFF_CG_Y,   248);
+    shadow_set(&regs, OFF_LAVA_X, 600);  shadow_set(&regs, OFF_LAVA_Y, 248);
+    shadow_flush(&regs);
 
     int speed_cg   = 1;
     int speed_lava = 2;
     bool collision = false;
 
     while (1) {
-        // ~16 ms for ~60 Hz frame
-        usleep(16666);
+        // ~16 ms for ~60 Hz frame (virtual under DINO_BUS=sim)
+        tick_sleep_ns(16666000);
 
         // read pushbuttons (active‐low)
-        uint32_t keys = *r_keys & 0x7;  
+        uint32_t keys = regbus_read(bus, OFF_KEYS) & 0x7;  
         // KEY0=bit0, KEY1=bit1, KEY2=bit2
 
+        uint32_t dino_x = shadow_get(&regs, OFF_DINO_X);
+        uint32_t dino_y = shadow_get(&regs, OFF_DINO_Y);
+        uint32_t cg_x   = shadow_get(&regs, OFF_CG_X);
+        uint32_t cg_y   = shadow_get(&regs, OFF_CG_Y);
+        uint32_t lava_x = shadow_get(&regs, OFF_LAVA_X);
+        uint32_t lava_y = shadow_get(&regs, OFF_LAVA_Y);
+
         // dino up/down via KEY0/KEY1
-        if (!(keys & 0x1))  (*r_dino_y)--;
-        if (!(keys & 0x2))  (*r_dino_y)++;
+        if (!(keys & 0x1))  dino_y--;
+        if (!(keys & 0x2))  dino_y++;
 
         // obstacle motion
         if (!collision) {
-            *r_cg_x   -= speed_cg;
-            *r_lava_x -= speed_lava;
+            cg_x   -= speed_cg;
+            lava_x -= speed_lava;
 
-            if ((int)*r_cg_x + CG_W <= 0) {
-                *r_cg_x = SCREEN_W;
+            if ((int)cg_x + CG_W <= 0) {
+                cg_x = SCREEN_W;
                 speed_cg++;
             }
-            if ((int)*r_lava_x + LAVA_W <= 0) {
-                *r_lava_x = SCREEN_W;
+            if ((int)lava_x + LAVA_W <= 0) {
+                lava_x = SCREEN_W;
                 speed_lava++;
             }
         }
 
         // collision detection
         if (!collision &&
-            ( overlap(*r_dino_x, *r_dino_y, DINO_W, DINO_H,
-                      *r_cg_x,   *r_cg_y,   CG_W,   CG_H)   ||
-              overlap(*r_dino_x, *r_dino_y, DINO_W, DINO_H,
-                      *r_lava_x, *r_lava_y, LAVA_W, LAVA_H) ))
+            ( overlap(dino_x, dino_y, DINO_W, DINO_H,
+                      cg_x,   cg_y,   CG_W,   CG_H)   ||
+              overlap(dino_x, dino_y, DINO_W, DINO_H,
+                      lava_x, lava_y, LAVA_W, LAVA_H) ))
         {
             collision = true;
         }
@@ -109,15 +107,19 @@ int main() {
         // on collision, wait for KEY2 to restart
         if (collision) {
             if (!(keys & 0x4)) {  // KEY2 pressed
-                *r_cg_x   = 400;   speed_cg   = 1;
-                *r_lava_x = 600;   speed_lava = 2;
+                cg_x   = 400;   speed_cg   = 1;
+                lava_x = 600;   speed_lava = 2;
                 collision = false;
             }
         }
+
+        shadow_set(&regs, OFF_DINO_Y, dino_y);
+        shadow_set(&regs, OFF_CG_X,   cg_x);
+        shadow_set(&regs, OFF_LAVA_X, lava_x);
+        shadow_flush(&regs);
     }
 
     // never reached
-    munmap(lw_base, LW_BRIDGE_SPAN);
-    close(fd);
+    regbus_close(bus);
     return 0;
 }
@@ -0,0 +1,338 @@
+/*  dino_batch.c – structure-of-arrays version of dino_sim for many games
+ *
+ *  A physics step lasts DINO_BATCH_CYCLES_PER_PHYSICS clocks with the dino
+ *  and the obstacles standing still, so only its first clock can see a
+ *  collision: game over, pickup and smashing all happen there, and what
+ *  gets smashed lands at x = 2000, out of reach.  The rest of the step is
+ *  just the godzilla timer counting, and the last clock of the motion
+ *  period is also the motion update.
+ *
+ *  Every lane does the same work whatever its state; branches are written
+ *  as selects so the loops stay vectorizable.
+ */
+
+#include "dino_batch.h"
+#include "../controller/workq.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define COLLIDE(ax, ay, bx, by, aw) \
+    (((ax) < (((bx) + 32) & 0x7FF)) & ((((ax) + (aw)) & 0x7FF) > (bx)) & \
+     ((ay) < (((by) + 32) & 0x7FF)) & ((((ay) + 32) & 0x7FF) > (by)))
+
+/* y positions nobody writes */
+#define S_CAC_Y    248
+#define GROUND_Y_  248
+#define PTR_Y      200
+
+static void power_on(struct dino_batch *b)
+{
+    for (uint32_t i = 0; i < b->n; i++) {
+        b->lfsr[i]    = 0x2B;
+        b->s_cac_x[i] = 1200;  b->group_x[i]   = 1600;
+        b->lava_x[i]  = 1800;  b->ptr_x[i]     = 1400;
+        b->speed[i]   = 1;     b->powerup_x[i] = 800;
+        b->dino_x[i]  = 100;   b->y_fixed[i]   = GROUND_Y_FIXED;
+    }
+}
+
+int dino_batch_init(struct dino_batch *b, uint32_t n)
+{
+    /* rows: the fields, games, score_sum (2), reward, jump, done */
+    size_t row = ((size_t)n * 4 + 63) & ~(size_t)63;
+    size_t size = row * (DINO_N_FIELDS + 6);
+    uint32_t **field[DINO_N_FIELDS] = {
+        &b->s_cac_x, &b->group_x, &b->lava_x, &b->ptr_x, &b->powerup_x,
+        &b->lfsr, &b->speed, &b->passed, &b->score,
+        &b->game_over, &b->godzilla, &b->godzilla_timer,
+        (uint32_t **)&b->dino_x, (uint32_t **)&b->y_fixed,
+        (uint32_t **)&b->v_fixed, (uint32_t **)&b->gravity_timer,
+    };
+    unsigned char *p;
+
+    memset(b, 0, sizeof *b);
+    if (posix_memalign(&b->mem, 64, size))
+        return -1;
+    memset(b->mem, 0, size);
+
+    p = b->mem;
+    for (int f = 0; f < DINO_N_FIELDS; f++, p += row)
+        *field[f] = (uint32_t *)p;
+    b->games     = (uint32_t *)p;  p += row;
+    b->score_sum = (uint64_t *)p;  p += 2 * row;
+    b->reward    = (int32_t *)p;   p += row;
+    b->jump      = p;              p += row;
+    b->done      = p;
+    b->n      = n;
+    b->stride = (uint32_t)(row / 4);
+
+    power_on(b);
+    return 0;
+}
+
+void dino_batch_free(struct dino_batch *b)
+{
+    if (b->pool) {
+        workq_destroy(b->pool);
+        free(b->pool);
+        b->pool = NULL;
+    }
+    free(b->mem);
+    b->mem = NULL;
+}
+
+void dino_batch_reset(struct dino_batch *b)
+{
+    memset(b->mem, 0, (size_t)b->stride * 4 * (DINO_N_FIELDS + 6));
+    power_on(b);
+}
+
+/* replay: everything but the lfsr (and the controller's dino) */
+static void reset_finished(struct dino_batch *b, uint32_t lo, uint32_t hi)
+{
+    for (uint32_t i = lo; i < hi; i++) {
+        if (!b->game_over[i])
+            continue;
+        b->games[i]++;
+        b->score_sum[i] += b->score[i];
+
+        b->s_cac_x[i] = 1200;  b->group_x[i]   = 1600;
+        b->lava_x[i]  = 1800;  b->ptr_x[i]     = 1400;
+        b->speed[i]   = 1;     b->powerup_x[i] = 800;
+        b->passed[i]  = 0;     b->score[i]     = 0;
+        b->game_over[i] = 0;
+        b->godzilla[i]  = 0;   b->godzilla_timer[i] = 0;
+
+        b->dino_x[i]  = 100;   b->y_fixed[i]   = GROUND_Y_FIXED;
+        b->v_fixed[i] = 0;     b->gravity_timer[i] = 0;
+    }
+}
+
+static void physics(struct dino_batch *restrict b, const uint8_t *restrict jump,
+                    uint32_t lo, uint32_t hi)
+{
+    int32_t *restrict x  = b->dino_x;
+    int32_t *restrict y  = b->y_fixed;
+    int32_t *restrict v  = b->v_fixed;
+    int32_t *restrict gt = b->gravity_timer;
+
+#pragma GCC ivdep                           /* lanes never alias */
+    for (uint32_t i = lo; i < hi; i++) {
+        int32_t want = (jump[i] != 0) & (y[i] == GROUND_Y_FIXED);
+        int32_t vi   = want ? INITIAL_VELOCITY : v[i];
+        int32_t ti   = gt[i] + 1;
+        int32_t fall = ti >= GRAVITY_DELAY;
+
+        x[i] += want ? JUMP_DX : 0;
+        vi   += fall ? GRAVITY : 0;
+        ti    = fall ? 0 : ti;
+
+        int32_t yi = y[i] + vi;
+        int32_t landed = yi > GROUND_Y_FIXED;
+        y[i]  = landed ? GROUND_Y_FIXED : yi;
+        v[i]  = landed ? 0 : vi;
+        gt[i] = ti;
+    }
+}
+
+/* The first clock after a write, then len - 1 clocks of counting. */
+static void settle(struct dino_batch *restrict b, uint32_t len, uint32_t lo, uint32_t hi)
+{
+    uint32_t *restrict sc = b->s_cac_x, *restrict gr = b->group_x;
+    uint32_t *restrict lv = b->lava_x,  *restrict pt = b->ptr_x;
+    uint32_t *restrict pw = b->powerup_x;
+    uint32_t *restrict go = b->game_over;
+    uint32_t *restrict gz = b->godzilla, *restrict gtm = b->godzilla_timer;
+    const int32_t *restrict dx = b->dino_x, *restrict dy = b->y_fixed;
+
+#pragma GCC ivdep                           /* lanes never alias */
+    for (uint32_t i = lo; i < hi; i++) {
+        uint32_t ax = (uint32_t)dx[i] & 0x3FF;
+        uint32_t ay = (uint32_t)(dy[i] >> FIXED_SHIFT) & 0x3FF;
+        uint32_t live = !go[i];
+
+        uint32_t h_sc = COLLIDE(ax, ay, sc[i], S_CAC_Y,   32);
+        uint32_t h_gr = COLLIDE(ax, ay, gr[i], GROUND_Y_, 0);     /* 64 in 6 bits */
+        uint32_t h_lv = COLLIDE(ax, ay, lv[i], GROUND_Y_, 32);
+        uint32_t h_pt = COLLIDE(ax, ay, pt[i], PTR_Y,     32);
+        uint32_t h_pw = COLLIDE(ax, ay, pw[i], GROUND_Y_, 32);
+        uint32_t any  = h_sc | h_gr | h_lv | h_pt;
+
+        uint32_t g = gz[i], t = gtm[i];
+        uint32_t smash = live & g;
+
+        /* first clock, in the RTL's assignment order */
+        uint32_t ng = g, nt = t;
+        ng = h_pw ? 1 : ng;
+        nt = h_pw ? 0 : nt;
+        nt = g ? t + 1 : nt;
+        uint32_t timeout = t >= DINO_GODZILLA_LIMIT;
+        ng = timeout ? 0 : ng;
+        nt = timeout ? 0 : nt;
+
+        /* then len - 1 clocks of the timer alone */
+        uint32_t late = ng & (nt + (len - 2) >= DINO_GODZILLA_LIMIT);
+        nt = ng ? nt + (len - 1) : nt;
+        ng = late ? 0 : ng;
+        nt = late ? 0 : nt;
+
+        go[i]  = go[i] | (live & !g & any);
+        gz[i]  = live ? ng : g;
+        gtm[i] = live ? nt : t;
+        pw[i]  = live & h_pw ? DINO_SMASHED_X : pw[i];
+        sc[i]  = smash & h_sc ? DINO_SMASHED_X : sc[i];
+        gr[i]  = smash & h_gr ? DINO_SMASHED_X : gr[i];
+        lv[i]  = smash & h_lv ? DINO_SMASHED_X : lv[i];
+        pt[i]  = smash & h_pt ? DINO_SMASHED_X : pt[i];
+    }
+}
+
+static inline uint32_t respawn(uint32_t x, uint32_t sp, uint32_t off)
+{
+    return x <= sp ? ((DINO_HACTIVE + off) & 0x7FF) : ((x - sp) & 0x7FF);
+}
+
+static void motion(struct dino_batch *restrict b, uint32_t lo, uint32_t hi)
+{
+    uint32_t *restrict sc = b->s_cac_x, *restrict gr = b->group_x;
+    uint32_t *restrict lv = b->lava_x,  *restrict pt = b->ptr_x;
+    uint32_t *restrict pw = b->powerup_x;
+    uint32_t *restrict lf = b->lfsr, *restrict spd = b->speed;
+    uint32_t *restrict pc = b->passed, *restrict scr = b->score;
+    const uint32_t *restrict go = b->game_over;
+    int32_t  *restrict rw = b->reward;
+    uint8_t  *restrict dn = b->done;
+
+#pragma GCC ivdep                           /* lanes never alias */
+    for (uint32_t i = lo; i < hi; i++) {
+        uint32_t live = !go[i];
+        uint32_t l = lf[i], sp = spd[i];
+        uint32_t passed = (sc[i] <= sp) | (gr[i] <= sp) | (lv[i] <= sp) | (pt[i] <= sp);
+
+        uint32_t n_sc = respawn(sc[i], sp, l << 4);
+        uint32_t n_gr = respawn(gr[i], sp, (l ^ 0x3F) << 4);
+        uint32_t n_lv = respawn(lv[i], sp, (l & 0xF) << 6);
+        uint32_t n_pt = respawn(pt[i], sp, (l >> 2) << 6);
+        uint32_t n_pw = respawn(pw[i], sp, (l & 0x1F) << 5);
+        uint32_t n_l  = ((l << 1) & 0x3E) | (((l >> 5) ^ (l >> 4)) & 1);
+
+        uint32_t n_pc = passed ? (pc[i] + 1) & 0x1F : pc[i];
+        uint32_t up   = pc[i] >= 12;
+        n_pc = up ? 0 : n_pc;
+        uint32_t n_sp = up ? (sp + 1) & 0x7FF : sp;
+        uint32_t n_sr = scr[i] == 99999 ? 0 : scr[i] + 1;
+
+        sc[i]  = live ? n_sc : sc[i];
+        gr[i]  = live ? n_gr : gr[i];
+        lv[i]  = live ? n_lv : lv[i];
+        pt[i]  = live ? n_pt : pt[i];
+        pw[i]  = live ? n_pw : pw[i];
+        lf[i]  = live ? n_l  : l;
+        pc[i]  = live ? n_pc : pc[i];
+        spd[i] = live ? n_sp : sp;
+        scr[i] = live ? n_sr : scr[i];
+        rw[i]  = (int32_t)live;
+        dn[i]  = (uint8_t)!live;
+    }
+}
+
+void dino_batch_step(struct dino_batch *b, const uint8_t *jump, uint32_t lo, uint32_t hi)
+{
+    reset_finished(b, lo, hi);
+
+    for (unsigned k = 0; k < DINO_BATCH_SUBSTEPS; k++) {
+        uint32_t len = DINO_BATCH_CYCLES_PER_PHYSICS;
+        if (k == DINO_BATCH_SUBSTEPS - 1)       /* ends with the motion update */
+            len = DINO_MOTION_PERIOD - k * DINO_BATCH_CYCLES_PER_PHYSICS;
+
+        physics(b, jump, lo, hi);
+        settle(b, len, lo, hi);
+    }
+    motion(b, lo, hi);
+}
+
+/* whole 1024-lane slices keep every row's slice on its own lines */
+static void step_slice(void *ctx, unsigned k)
+{
+    struct dino_batch *b = ctx;
+    uint32_t lo = k * DINO_BATCH_SLICE;
+    uint32_t hi = b->n - lo > DINO_BATCH_SLICE ? lo + DINO_BATCH_SLICE : b->n;
+
+    dino_batch_step(b, b->jump, lo, hi);
+}
+
+void dino_batch_step_all(struct dino_batch *b, unsigned threads)
+{
+    unsigned slices = (b->n + DINO_BATCH_SLICE - 1) / DINO_BATCH_SLICE;
+
+    if (threads < 1)
+        threads = 1;
+    if (threads > WORKQ_MAX_THREADS)
+        threads = WORKQ_MAX_THREADS;
+    if (b->pool && b->pool_threads != threads) {
+        workq_destroy(b->pool);
+        free(b->pool);
+        b->pool = NULL;
+    }
+    if (!b->pool && threads > 1 && (b->pool = malloc(sizeof *b->pool)) &&
+        workq_init(b->pool, threads, -1, 0)) {
+        free(b->pool);                  // no threads: the caller does it all
+        b->pool = NULL;
+    }
+    b->pool_threads = threads;
+
+    if (b->pool) {
+        workq_run(b->pool, slices, step_slice, b);
+    } else {
+        for (unsigned k = 0; k < slices; k++)
+            step_slice(b, k);
+    }
+}
+
+struct dino_batch *dino_batch_new(uint32_t n)
+{
+    struct dino_batch *b = malloc(sizeof *b);
+    if (b && dino_batch_init(b, n)) {
+        free(b);
+        b = NULL;
+    }
+    return b;
+}
+
+void dino_batch_delete(struct dino_batch *b)
+{
+    if (b)
+        dino_batch_free(b);
+    free(b);
+}
+
+int32_t *dino_batch_state(struct dino_batch *b, uint32_t *stride)
+{
+    *stride = b->stride;
+    return b->mem;
+}
+
+uint8_t *dino_batch_jump(struct dino_batch *b)   { return b->jump; }
+int32_t *dino_batch_reward(struct dino_batch *b) { return b->reward; }
+uint8_t *dino_batch_done(struct dino_batch *b)   { return b->done; }
+
+void dino_batch_get(const struct dino_batch *b, uint32_t i, struct dino_state *s, struct dino *d)
+{
+    s->s_cac_x        = (uint16_t)b->s_cac_x[i];
+    s->group_x        = (uint16_t)b->group_x[i];
+    s->lava_x         = (uint16_t)b->lava_x[i];
+    s->ptr_x          = (uint16_t)b->ptr_x[i];
+    s->powerup_x      = (uint16_t)b->powerup_x[i];
+    s->lfsr           = (uint8_t)b->lfsr[i];
+    s->obstacle_speed = (uint16_t)b->speed[i];
+    s->passed_count   = (uint8_t)b->passed[i];
+    s->score          = b->score[i];
+    s->game_over      = (uint8_t)b->game_over[i];
+    s->godzilla_mode  = (uint8_t)b->godzilla[i];
+    s->godzilla_timer = b->godzilla_timer[i];
+
+    d->x             = b->dino_x[i];
+    d->y_fixed       = b->y_fixed[i];
+    d->v_fixed       = b->v_fixed[i];
+    d->gravity_timer = b->gravity_timer[i];
+}
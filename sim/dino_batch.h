@@ -0,0 +1,95 @@
+#ifndef DINO_BATCH_H
+#define DINO_BATCH_H
+
+#include <stdint.h>
+#include "dino_sim.h"
+#include "dino_play.h"
+
+/* Many independent games stepped together, one array per field.
+ *
+ * One step is one motion period.  It is split into the controller's
+ * physics steps (PHYSICS_HZ): each one moves the dino with the jump
+ * physics from controller/dino_physics.h, writes its position and lets
+ * the game logic run until the next write; the motion update is the last
+ * clock of the step.  Only state that affects play is kept (no bcd,
+ * clouds, night or sprite_state).
+ *
+ * The per-field loops are written so the compiler vectorizes them (SSE/
+ * AVX2 on a PC, NEON on the HPS with -mfpu=neon); lanes never interact,
+ * so ranges of lanes can be stepped from different threads.
+ */
+
+#define DINO_BATCH_CYCLES_PER_PHYSICS  DINO_PLAY_CYCLES_PER_PHYSICS
+#define DINO_BATCH_SUBSTEPS            DINO_PLAY_SUBSTEPS
+#define DINO_BATCH_SLICE               1024    // lanes a worker takes at a time
+
+struct workq;
+
+/* Fields in the order they sit in memory: field f of lane i is at
+   (int32_t *)mem + f * stride + i, so the whole state is one 2-D array. */
+enum dino_batch_field {
+    DINO_F_S_CAC_X, DINO_F_GROUP_X, DINO_F_LAVA_X, DINO_F_PTR_X, DINO_F_POWERUP_X,
+    DINO_F_LFSR, DINO_F_SPEED, DINO_F_PASSED, DINO_F_SCORE,
+    DINO_F_GAME_OVER, DINO_F_GODZILLA, DINO_F_GODZILLA_TIMER,
+    DINO_F_DINO_X, DINO_F_Y_FIXED, DINO_F_V_FIXED, DINO_F_GRAVITY_TIMER,
+    DINO_N_FIELDS
+};
+
+struct dino_batch {
+    uint32_t n;
+    uint32_t stride;                    // lanes per field row, padded to 64 bytes
+
+    /* game (vga_ball.sv) */
+    uint32_t *s_cac_x, *group_x, *lava_x, *ptr_x, *powerup_x;
+    uint32_t *lfsr, *speed, *passed, *score;
+    uint32_t *game_over, *godzilla, *godzilla_timer;
+
+    /* dino (controller) */
+    int32_t  *dino_x, *y_fixed, *v_fixed, *gravity_timer;
+
+    /* per lane totals, updated when a finished game is reset */
+    uint32_t *games;
+    uint64_t *score_sum;
+
+    /* step I/O: jump is read by dino_batch_step_all(), reward is 1 for
+       every lane still alive at the motion update, done = game_over */
+    uint8_t  *jump, *done;
+    int32_t  *reward;
+
+    void     *mem;
+
+    /* dino_batch_step_all()'s workers, started on first use and kept */
+    struct workq *pool;
+    unsigned      pool_threads;
+};
+
+/* Returns 0 or -1 (no memory).  All lanes start in the power-on state. */
+int  dino_batch_init(struct dino_batch *b, uint32_t n);
+void dino_batch_free(struct dino_batch *b);
+
+/* Every lane back to power-on, totals cleared. */
+void dino_batch_reset(struct dino_batch *b);
+
+/* One step for lanes [lo, hi).  jump[i] holds the jump button of lane i
+   for the whole step.  A lane whose game ended is reset first, the way
+   replay does it (plus the dino back at the start). */
+void dino_batch_step(struct dino_batch *b, const uint8_t *jump, uint32_t lo, uint32_t hi);
+
+/* All lanes with b->jump as input, in DINO_BATCH_SLICE slices over
+   threads (1 = caller only).  The threads are started on the first call
+   and kept for the next (restarted if threads changes), so a step per
+   call costs no thread creation. */
+void dino_batch_step_all(struct dino_batch *b, unsigned threads);
+
+/* For callers that can't see the struct (the Python bindings). */
+struct dino_batch *dino_batch_new(uint32_t n);
+void     dino_batch_delete(struct dino_batch *b);
+int32_t *dino_batch_state(struct dino_batch *b, uint32_t *stride);
+uint8_t *dino_batch_jump(struct dino_batch *b);
+int32_t *dino_batch_reward(struct dino_batch *b);
+uint8_t *dino_batch_done(struct dino_batch *b);
+
+/* Lane i as a dino_state (fields the batch doesn't keep are left alone). */
+void dino_batch_get(const struct dino_batch *b, uint32_t i, struct dino_state *s, struct dino *d);
+
+#endif
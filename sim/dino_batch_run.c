@@ -0,0 +1,213 @@
+/*  dino_batch_run.c – steps many games at once and reports steps/s
+ *
+ *  Every lane plays a random jumper.  Lanes are split into blocks that
+ *  threads take turns on; each block runs all its steps before the next
+ *  so it stays in cache.  --check replays some lanes through dino_sim
+ *  with the same inputs and compares them every step.
+ */
+
+#include "dino_batch.h"
+#include "dino_play.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BLOCK 1024                  /* lanes per work item */
+
+struct job {
+    struct dino_batch *b;
+    uint64_t steps;
+    unsigned jump_odds;             /* jump on ~1 in this many steps */
+    uint32_t next_block;            /* shared, atomic */
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint32_t xorshift32(uint32_t x)
+{
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return x;
+}
+
+/* The random jumper: same inputs for the same lane and step everywhere. */
+static void policy(uint32_t *rng, uint8_t *jump, uint32_t n, unsigned odds)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        rng[i]  = xorshift32(rng[i]);
+        jump[i] = rng[i] % odds == 0;
+    }
+}
+
+static void seed(uint32_t *rng, uint32_t lo, uint32_t hi)
+{
+    for (uint32_t i = lo; i < hi; i++)
+        rng[i - lo] = 0x9E3779B9u * (i + 1);
+}
+
+static void *worker(void *arg)
+{
+    struct job *job = arg;
+    struct dino_batch *b = job->b;
+    uint32_t rng[BLOCK];
+    uint8_t  jump[BLOCK];
+
+    for (;;) {
+        uint32_t lo = __atomic_fetch_add(&job->next_block, BLOCK, __ATOMIC_RELAXED);
+        if (lo >= b->n)
+            return NULL;
+        uint32_t hi = lo + BLOCK < b->n ? lo + BLOCK : b->n;
+
+        seed(rng, lo, hi);
+        for (uint64_t t = 0; t < job->steps; t++) {
+            policy(rng, jump, hi - lo, job->jump_odds);
+            dino_batch_step(b, jump - lo, lo, hi);
+        }
+    }
+}
+
+static int same(const struct dino_state *a, const struct dino *da,
+                const struct dino_state *s, const struct dino *ds)
+{
+    return a->s_cac_x == s->s_cac_x && a->group_x == s->group_x &&
+           a->lava_x == s->lava_x && a->ptr_x == s->ptr_x &&
+           a->powerup_x == s->powerup_x && a->lfsr == s->lfsr &&
+           a->obstacle_speed == s->obstacle_speed &&
+           a->passed_count == s->passed_count && a->score == s->score &&
+           a->game_over == s->game_over && a->godzilla_mode == s->godzilla_mode &&
+           a->godzilla_timer == s->godzilla_timer &&
+           !memcmp(da, ds, sizeof *da);
+}
+
+/* Lanes [0, n) against dino_sim driven the way the controller would. */
+static int check(uint32_t n, uint64_t steps, unsigned odds)
+{
+    struct dino_batch b;
+    struct dino_state *ref = calloc(n, sizeof *ref);
+    struct dino *dino = calloc(n, sizeof *dino);
+    uint32_t *rng = calloc(n, sizeof *rng);
+    uint8_t  *jump = calloc(n, 1);
+    uint64_t games = 0;
+
+    if (!ref || !dino || !rng || !jump || dino_batch_init(&b, n)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    seed(rng, 0, n);
+    for (uint32_t i = 0; i < n; i++) {
+        dino_sim_init(&ref[i]);
+        dino[i] = (struct dino){ .x = 100, .y_fixed = GROUND_Y_FIXED };
+    }
+
+    for (uint64_t t = 0; t < steps; t++) {
+        policy(rng, jump, n, odds);
+        dino_batch_step(&b, jump, 0, n);
+
+        for (uint32_t i = 0; i < n; i++) {
+            struct dino_state *s = &ref[i];
+            struct dino *d = &dino[i];
+
+            if (s->game_over) {
+                dino_play_replay(s, d);
+                games++;
+            }
+            dino_play_tick(s, d, jump[i]);
+
+            struct dino_state a = *s;
+            struct dino da;
+            dino_batch_get(&b, i, &a, &da);
+            if (!same(&a, &da, s, d)) {
+                printf("lane %u differs after step %llu\n", i, (unsigned long long)t);
+                printf("batch: x=%u,%u,%u,%u,%u lfsr=%02x spd=%u pc=%u score=%u go=%u gz=%u gt=%llu dino=%d,%d\n",
+                       a.s_cac_x, a.group_x, a.lava_x, a.ptr_x, a.powerup_x, a.lfsr,
+                       a.obstacle_speed, a.passed_count, a.score, a.game_over,
+                       a.godzilla_mode, (unsigned long long)a.godzilla_timer, da.x, da.y_fixed);
+                printf("model: x=%u,%u,%u,%u,%u lfsr=%02x spd=%u pc=%u score=%u go=%u gz=%u gt=%llu dino=%d,%d\n",
+                       s->s_cac_x, s->group_x, s->lava_x, s->ptr_x, s->powerup_x, s->lfsr,
+                       s->obstacle_speed, s->passed_count, s->score, s->game_over,
+                       s->godzilla_mode, (unsigned long long)s->godzilla_timer, d->x, d->y_fixed);
+                return 1;
+            }
+        }
+    }
+    printf("check: %u lanes x %llu steps identical (%llu games)\n",
+           n, (unsigned long long)steps, (unsigned long long)games);
+    dino_batch_free(&b);
+    return 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-n LANES] [-s STEPS] [-j THREADS] [-p JUMP_ODDS]\n"
+                    "       [--check LANES]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t lanes = 16384, check_lanes = 0;
+    uint64_t steps = 3000;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned odds = 40;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            lanes = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            steps = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            threads = strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+            odds = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--check") && i + 1 < argc)
+            check_lanes = strtoul(argv[++i], NULL, 0);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (odds < 1) odds = 1;
+
+    if (check_lanes)
+        return check(check_lanes, steps, odds);
+
+    struct dino_batch b;
+    if (dino_batch_init(&b, lanes)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    struct job job = { .b = &b, .steps = steps, .jump_odds = odds };
+    pthread_t tid[threads];
+
+    double t0 = now_s();
+    for (long t = 0; t < threads; t++)
+        pthread_create(&tid[t], NULL, worker, &job);
+    for (long t = 0; t < threads; t++)
+        pthread_join(tid[t], NULL);
+    double dt = now_s() - t0;
+
+    uint64_t games = 0, score = 0;
+    for (uint32_t i = 0; i < lanes; i++) {
+        games += b.games[i];
+        score += b.score_sum[i];
+    }
+
+    double total = (double)lanes * steps;
+    printf("%u lanes x %llu steps on %ld threads: %.3f s, %.1f M steps/s "
+           "(%.1f M physics steps/s)\n",
+           lanes, (unsigned long long)steps, threads, dt, total / dt / 1e6,
+           total * DINO_BATCH_SUBSTEPS / dt / 1e6);
+    printf("%llu games finished, mean score %.1f\n",
+           (unsigned long long)games, games ? (double)score / games : 0.0);
+
+    dino_batch_free(&b);
+    return 0;
+}
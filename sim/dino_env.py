@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Batched Dino Run environment over libdinosim.so (see dino_batch.h).
+
+obs, action, reward and done are NumPy views of the simulator's own
+arrays, so nothing is copied per step: write actions into env.action (or
+pass them to step()), read the rest after step() returns.  The native
+step runs with the GIL released (ctypes drops it for every call).
+
+    env = DinoEnv(16384)
+    obs = env.reset()
+    for _ in range(1000):
+        env.action[:] = policy(obs)
+        obs, reward, done = env.step()
+
+Build the library first:  make libdinosim.so
+"""
+
+import ctypes
+import os
+from pathlib import Path
+
+import numpy as np
+
+# Rows of obs, in dino_batch_field order
+FIELDS = (
+    "s_cac_x", "group_x", "lava_x", "ptr_x", "powerup_x",
+    "lfsr", "speed", "passed", "score",
+    "game_over", "godzilla", "godzilla_timer",
+    "dino_x", "y_fixed", "v_fixed", "gravity_timer",
+)
+
+# ---------- Library ----------------------------------------------------------
+def _load(path=None):
+    lib = ctypes.CDLL(str(path or Path(__file__).with_name("libdinosim.so")))
+    vp, u32 = ctypes.c_void_p, ctypes.c_uint32
+    lib.dino_batch_new.restype     = vp
+    lib.dino_batch_new.argtypes    = [u32]
+    lib.dino_batch_delete.argtypes = [vp]
+    lib.dino_batch_reset.argtypes  = [vp]
+    lib.dino_batch_step_all.argtypes = [vp, ctypes.c_uint]
+    lib.dino_batch_state.restype   = ctypes.POINTER(ctypes.c_int32)
+    lib.dino_batch_state.argtypes  = [vp, ctypes.POINTER(u32)]
+    lib.dino_batch_jump.restype    = ctypes.POINTER(ctypes.c_uint8)
+    lib.dino_batch_jump.argtypes   = [vp]
+    lib.dino_batch_reward.restype  = ctypes.POINTER(ctypes.c_int32)
+    lib.dino_batch_reward.argtypes = [vp]
+    lib.dino_batch_done.restype    = ctypes.POINTER(ctypes.c_uint8)
+    lib.dino_batch_done.argtypes   = [vp]
+    return lib
+
+# ---------- Environment ------------------------------------------------------
+class DinoEnv:
+    """n independent games; one step() is one motion period for all of them."""
+
+    def __init__(self, n, threads=None, lib=None):
+        self._lib = _load(lib)
+        self._b = self._lib.dino_batch_new(n)
+        if not self._b:
+            raise MemoryError("dino_batch_new(%d)" % n)
+        self.n = n
+        self.threads = threads or os.cpu_count() or 1
+
+        stride = ctypes.c_uint32()
+        state = self._lib.dino_batch_state(self._b, ctypes.byref(stride))
+        rows = np.ctypeslib.as_array(state, shape=(len(FIELDS), stride.value))
+        self.obs    = rows[:, :n]
+        self.action = np.ctypeslib.as_array(self._lib.dino_batch_jump(self._b), shape=(n,))
+        self.reward = np.ctypeslib.as_array(self._lib.dino_batch_reward(self._b), shape=(n,))
+        self.done   = np.ctypeslib.as_array(self._lib.dino_batch_done(self._b), shape=(n,))
+
+    def field(self, name):
+        """One row of obs by name, e.g. env.field("score")."""
+        return self.obs[FIELDS.index(name)]
+
+    def reset(self):
+        self._lib.dino_batch_reset(self._b)
+        return self.obs
+
+    def step(self, action=None):
+        """Finished games restart at the start of the next step."""
+        if action is not None:
+            self.action[:] = action
+        self._lib.dino_batch_step_all(self._b, self.threads)
+        return self.obs, self.reward, self.done
+
+    def close(self):
+        if self._b:
+            self.obs = self.action = self.reward = self.done = None
+            self._lib.dino_batch_delete(self._b)
+            self._b = None
+
+    def __del__(self):
+        self.close()
+
+# ---------- Main -------------------------------------------------------------
+if __name__ == "__main__":
+    import sys
+    import time
+
+    n     = int(sys.argv[1]) if len(sys.argv) > 1 else 16384
+    steps = int(sys.argv[2]) if len(sys.argv) > 2 else 3000
+
+    env = DinoEnv(n)
+    env.reset()
+    rng = np.random.default_rng(1)
+    games = 0
+    t0 = time.perf_counter()
+    for _ in range(steps):
+        obs, reward, done = env.step(rng.random(n) < 1 / 40)
+        games += int(done.sum())
+    dt = time.perf_counter() - t0
+    print(f"{n} lanes x {steps} steps: {n * steps / dt / 1e6:.1f} M steps/s, "
+          f"{games} games over")
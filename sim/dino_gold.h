@@ -0,0 +1,87 @@
+#ifndef DINO_GOLD_H
+#define DINO_GOLD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "dino_render.h"
+
+/* golden/NAME.gold, shared by dino_golden and vga_golden: "DINOGOLD",
+ * the frame count, then per frame its byte count and the frame XORed
+ * with the one before (the first with black), run length coded as
+ * (u16 run, r, g, b).  Frames are dino_render's, DINO_SCREEN_W x
+ * DINO_SCREEN_H RGB.
+ */
+
+#define DINO_GOLD_MAGIC  "DINOGOLD"
+#define DINO_GOLD_PIXELS (DINO_SCREEN_W * DINO_SCREEN_H)
+#define DINO_GOLD_BYTES  (DINO_GOLD_PIXELS * 3)
+#define DINO_GOLD_MAX    (DINO_GOLD_PIXELS * 5)     // worst case coded frame
+
+/* XOR with prev (NULL: black), run-length code into out; returns bytes used. */
+static inline size_t dino_gold_encode(const uint8_t *fb, const uint8_t *prev, uint8_t *out)
+{
+    size_t n = 0;
+
+    for (unsigned i = 0; i < DINO_GOLD_PIXELS; ) {
+        uint8_t px[3];
+        for (int c = 0; c < 3; c++)
+            px[c] = fb[3 * i + c] ^ (prev ? prev[3 * i + c] : 0);
+        unsigned run = 1;
+        while (i + run < DINO_GOLD_PIXELS && run < 0xFFFF) {
+            const uint8_t *q = fb + 3 * (i + run), *p = prev ? prev + 3 * (i + run) : NULL;
+            if ((q[0] ^ (p ? p[0] : 0)) != px[0] || (q[1] ^ (p ? p[1] : 0)) != px[1] ||
+                (q[2] ^ (p ? p[2] : 0)) != px[2])
+                break;
+            run++;
+        }
+        out[n++] = (uint8_t)run;
+        out[n++] = (uint8_t)(run >> 8);
+        memcpy(out + n, px, 3);
+        n += 3;
+        i += run;
+    }
+    return n;
+}
+
+/* Undoes dino_gold_encode() in place on fb, which holds the previous frame. */
+static inline int dino_gold_decode(const uint8_t *in, size_t len, uint8_t *fb)
+{
+    unsigned i = 0;
+
+    for (size_t k = 0; k + 5 <= len; k += 5) {
+        unsigned run = in[k] | in[k + 1] << 8;
+        if (i + run > DINO_GOLD_PIXELS)
+            return -1;
+        for (; run; run--, i++) {
+            fb[3 * i]     ^= in[k + 2];
+            fb[3 * i + 1] ^= in[k + 3];
+            fb[3 * i + 2] ^= in[k + 4];
+        }
+    }
+    return i == DINO_GOLD_PIXELS ? 0 : -1;
+}
+
+/* Checks the header; the frame count into *count.  0, or -1 if f isn't one. */
+static inline int dino_gold_open(FILE *f, uint32_t *count)
+{
+    char magic[8];
+
+    if (fread(magic, 8, 1, f) != 1 || memcmp(magic, DINO_GOLD_MAGIC, 8))
+        return -1;
+    return fread(count, 4, 1, f) == 1 ? 0 : -1;
+}
+
+/* The next frame over fb (the one before it, zeroed for the first),
+   with buf DINO_GOLD_MAX bytes of scratch.  0, or -1 if it's damaged. */
+static inline int dino_gold_next(FILE *f, uint8_t *buf, uint8_t *fb)
+{
+    uint32_t len;
+
+    if (fread(&len, 4, 1, f) != 1 || len > DINO_GOLD_MAX || fread(buf, 1, len, f) != len)
+        return -1;
+    return dino_gold_decode(buf, len, fb);
+}
+
+#endif
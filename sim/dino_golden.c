@@ -0,0 +1,642 @@
+/*  dino_golden.c – golden-frame regression for the video path
+ *
+ *  Each golden/NAME.trace is a script of register writes and waits
+ *  played into dino_sim; every "frame" line renders the screen with
+ *  dino_render.  The frames are checked against golden/NAME.gold, or
+ *  written there with --update.  Scenarios run in parallel, one per
+ *  worker at a time.  Failures get a diff image each and one montage
+ *  (golden | rendered | diff at half size, a row per failing frame) in
+ *  golden-diff/ or --diff DIR, made if it isn't there; one that can't
+ *  be written fails the run.
+ *
+ *  Trace lines ('#' starts a comment):
+ *
+ *    write REG VALUE        dino_x dino_y ducking jumping lava_x lava_y replay
+ *    palette SPRITE I RGB [RGB]...
+ *                           colour I of a sprite's palette (the names in
+ *                           sprite_atlas.svh, any case) to an RGB565 value,
+ *                           and I + 1... to the next ones: over the bus as
+ *                           PAL_ADDR, then PAL_DATA for each
+ *    object E SPRITE X Y [flip] [prio=P] [pal=SPRITE] [off]
+ *                           OAM entry E (0-63): that sprite at X, Y,
+ *                           priority P (default 0, the front), in its own
+ *                           palette or another sprite's; off disables it
+ *    ticks N                N motion periods of clocks
+ *    clocks N
+ *    until FIELD OP VALUE [MAX_TICKS]
+ *                           tick by tick until e.g. "game_over == 1";
+ *                           a trace that runs out of ticks fails
+ *    frame [COUNT [TICKS]]  COUNT frames, TICKS motion periods apart
+ *
+ *  The .gold format is in dino_gold.h.  With --bus DIR each scenario's
+ *  bus writes, and the game state under each frame, also go to
+ *  DIR/NAME.bus for vga_golden to play into the RTL:
+ *
+ *    write ADDRESS VALUE
+ *    frame FIELD=VALUE ...  dino_render's inputs, bcd as bcd=D0,D1,D2,D3,D4
+ */
+
+#include "dino_gold.h"
+#include "dino_render.h"
+#include "dino_sim.h"
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FB_PIXELS     DINO_GOLD_PIXELS
+#define FB_BYTES      DINO_GOLD_BYTES
+#define MAX_FRAMES    1024              // per scenario
+#define MAX_SCENARIOS 256
+#define MAX_MONTAGE   16
+
+struct scenario {
+    char      name[256];
+    unsigned  frames;
+    uint8_t  *fb[MAX_FRAMES];           // rendered
+    unsigned  bad_frames;
+    uint64_t  bad_pixels;
+    int       first_bad;                // -1 = none
+    char      error[8192];              // trace or golden file trouble
+};
+
+struct job {
+    const char          *dir, *diff_dir, *bus_dir;
+    const struct dino_sprites *sprites;
+    int                  update;
+    unsigned             n;
+    unsigned             next;          // atomic
+    struct scenario     *sc[MAX_SCENARIOS];
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ------------------------------------------------------------------ */
+/*  traces                                                             */
+
+static const struct { const char *name; unsigned address; } regs[] = {
+    { "dino_x", DINO_REG_DINO_X }, { "dino_y", DINO_REG_DINO_Y },
+    { "ducking", DINO_REG_DUCKING }, { "jumping", DINO_REG_JUMPING },
+    { "lava_x", DINO_REG_LAVA_X }, { "lava_y", DINO_REG_LAVA_Y },
+    { "replay", DINO_REG_REPLAY },
+};
+
+#define FIELD(f) { #f, offsetof(struct dino_state, f), sizeof(((struct dino_state *)0)->f) }
+static const struct { const char *name; size_t off, size; } fields[] = {
+    FIELD(game_over), FIELD(godzilla_mode), FIELD(night_time), FIELD(score),
+    FIELD(sprite_state), FIELD(cloud_offset), FIELD(obstacle_speed),
+    FIELD(s_cac_x), FIELD(group_x), FIELD(lava_x), FIELD(ptr_x), FIELD(powerup_x),
+};
+
+static uint64_t field_value(const struct dino_state *s, int f)
+{
+    const uint8_t *p = (const uint8_t *)s + fields[f].off;
+    switch (fields[f].size) {
+    case 1:  return *p;
+    case 2:  return *(const uint16_t *)p;
+    case 4:  return *(const uint32_t *)p;
+    default: return *(const uint64_t *)p;
+    }
+}
+
+static int holds(uint64_t a, const char *op, uint64_t b)
+{
+    if (!strcmp(op, "==")) return a == b;
+    if (!strcmp(op, "!=")) return a != b;
+    if (!strcmp(op, "<"))  return a < b;
+    if (!strcmp(op, ">=")) return a >= b;
+    return -1;
+}
+
+/* A sprite by its sprite_atlas.svh name, any case; -1 if there's none. */
+static int rom_named(const char *name)
+{
+    for (int k = 0; k < DINO_N_ROMS; k++)
+        if (!strcasecmp(name, dino_rom_name[k]))
+            return k;
+    return -1;
+}
+
+/* A write on the bus, for --bus too. */
+static void bus_write(struct dino_state *s, FILE *bus, unsigned address, uint32_t value)
+{
+    dino_sim_write(s, address, value);
+    if (bus)
+        fprintf(bus, "write %u 0x%x\n", address, (unsigned)value);
+}
+
+/* The game state dino_render_frame() reads, by the RTL's names. */
+static void bus_frame(FILE *bus, const struct dino_state *s)
+{
+    fprintf(bus, "frame dino_x=%u dino_y=%u ducking=%u jumping=%u s_cac_x=%u s_cac_y=%u "
+                 "group_x=%u group_y=%u lava_x=%u lava_y=%u ptr_x=%u ptr_y=%u "
+                 "powerup_x=%u powerup_y=%u sprite_state=%u game_over=%u godzilla_mode=%u "
+                 "night_time=%u cloud_offset=%u bcd=%u,%u,%u,%u,%u\n",
+            s->dino_x, s->dino_y, s->ducking, s->jumping, s->s_cac_x, s->s_cac_y,
+            s->group_x, s->group_y, s->lava_x, s->lava_y, s->ptr_x, s->ptr_y,
+            s->powerup_x, s->powerup_y, s->sprite_state, s->game_over, s->godzilla_mode,
+            s->night_time, s->cloud_offset, s->bcd[0], s->bcd[1], s->bcd[2], s->bcd[3],
+            s->bcd[4]);
+}
+
+static int keep_frame(struct scenario *sc, struct dino_render *r, const struct dino_state *s,
+                      FILE *bus)
+{
+    if (sc->frames == MAX_FRAMES || !(sc->fb[sc->frames] = malloc(FB_BYTES)))
+        return -1;
+    dino_render_frame(r, s, sc->fb[sc->frames++]);
+    if (bus)
+        bus_frame(bus, s);
+    return 0;
+}
+
+/* Plays the trace at path; bus, if not NULL, gets the --bus script. */
+static int play(struct scenario *sc, const char *path, struct dino_render *r, FILE *bus)
+{
+    FILE *f = fopen(path, "r");
+    struct dino_state s;
+    char line[512];
+    int n = 0;
+
+    if (!f) {
+        snprintf(sc->error, sizeof sc->error, "can't open %s", path);
+        return -1;
+    }
+    dino_sim_init(&s);
+    dino_render_reset(r);
+
+    while (fgets(line, sizeof line, f)) {
+        char cmd[32], a[32], op[8];
+        long long x, y, e;
+        int k, used;
+
+        n++;
+        if (strchr(line, '#'))
+            *strchr(line, '#') = 0;
+        if (sscanf(line, "%31s", cmd) != 1)
+            continue;
+
+        if (!strcmp(cmd, "write") && sscanf(line, "%*s %31s %lli", a, &x) == 2) {
+            for (k = 0; k < (int)(sizeof regs / sizeof regs[0]); k++)
+                if (!strcmp(a, regs[k].name))
+                    break;
+            if (k == (int)(sizeof regs / sizeof regs[0]))
+                goto bad;
+            bus_write(&s, bus, regs[k].address, (uint32_t)x);
+        } else if (!strcmp(cmd, "palette") &&
+                   sscanf(line, "%*s %31s %lli %n", a, &x, &used) == 2 && x >= 0) {
+            if ((k = rom_named(a)) < 0)
+                goto bad;
+            unsigned base = r->pal_base[r->pal[k]], mask = r->pal_mask[r->pal[k]];
+            char *save, *end, *tok = strtok_r(line + used, " \t\n", &save);
+            if (!tok)
+                goto bad;
+            bus_write(&s, bus, DINO_REG_PAL_ADDR, base | (unsigned)x);
+            for (; tok; tok = strtok_r(NULL, " \t\n", &save), x++) {
+                y = strtoll(tok, &end, 0);
+                if (*end || x > mask)
+                    goto bad;
+                bus_write(&s, bus, DINO_REG_PAL_DATA, (uint32_t)y);
+                dino_render_palette(r, base | (unsigned)x, (uint16_t)y);
+            }
+        } else if (!strcmp(cmd, "object") &&
+                   sscanf(line, "%*s %lli %31s %lli %lli%n", &e, a, &x, &y, &used) == 4 &&
+                   e >= 0 && e < DINO_OAM_ENTRIES) {
+            unsigned pal, prio = 0;
+            int flip = 0, off = 0;
+            if ((k = rom_named(a)) < 0)
+                goto bad;
+            pal = r->pal[k];
+            char *save;
+            for (char *tok = strtok_r(line + used, " \t\n", &save); tok;
+                 tok = strtok_r(NULL, " \t\n", &save)) {
+                unsigned v;
+                if (!strcmp(tok, "flip"))
+                    flip = 1;
+                else if (!strcmp(tok, "off"))
+                    off = 1;
+                else if (sscanf(tok, "prio=%u", &v) == 1 && v < 8)
+                    prio = v;
+                else if (!strncmp(tok, "pal=", 4) && rom_named(tok + 4) >= 0)
+                    pal = r->pal[rom_named(tok + 4)];
+                else
+                    goto bad;
+            }
+            uint32_t word[2] = { DINO_OAM_POS(x, y), DINO_OAM_ATTR(r->pal[k], pal, flip, prio) };
+            if (off)
+                word[1] &= ~0x8000u;
+            for (unsigned i = 0; i < 2; i++) {
+                bus_write(&s, bus, DINO_REG_OAM + 2 * (unsigned)e + i, word[i]);
+                dino_render_oam(r, 2 * (unsigned)e + i, word[i]);
+            }
+        } else if (!strcmp(cmd, "ticks") && sscanf(line, "%*s %lli", &x) == 1) {
+            dino_sim_run(&s, x * DINO_MOTION_PERIOD);
+        } else if (!strcmp(cmd, "clocks") && sscanf(line, "%*s %lli", &x) == 1) {
+            dino_sim_run(&s, x);
+        } else if (!strcmp(cmd, "until") &&
+                   (k = sscanf(line, "%*s %31s %7s %lli %lli", a, op, &x, &y)) >= 3) {
+            int fi;
+            for (fi = 0; fi < (int)(sizeof fields / sizeof fields[0]); fi++)
+                if (!strcmp(a, fields[fi].name))
+                    break;
+            if (fi == (int)(sizeof fields / sizeof fields[0]) || holds(0, op, 0) < 0)
+                goto bad;
+            uint64_t max = k == 4 ? y : 100000, t = 0;
+            while (!holds(field_value(&s, fi), op, x)) {
+                if (t++ == max) {
+                    snprintf(sc->error, sizeof sc->error, "%s:%d: still waiting after %llu ticks",
+                             path, n, (unsigned long long)max);
+                    fclose(f);
+                    return -1;
+                }
+                dino_sim_tick(&s);
+            }
+        } else if (!strcmp(cmd, "frame")) {
+            long long count = 1, gap = 0;
+            sscanf(line, "%*s %lli %lli", &count, &gap);
+            for (long long i = 0; i < count; i++) {
+                if (i && gap)
+                    dino_sim_run(&s, gap * DINO_MOTION_PERIOD);
+                if (keep_frame(sc, r, &s, bus) < 0) {
+                    snprintf(sc->error, sizeof sc->error, "%s:%d: too many frames", path, n);
+                    fclose(f);
+                    return -1;
+                }
+            }
+        } else {
+            goto bad;
+        }
+    }
+    fclose(f);
+    return 0;
+
+bad:
+    snprintf(sc->error, sizeof sc->error, "%s:%d: can't parse", path, n);
+    fclose(f);
+    return -1;
+}
+
+/* ------------------------------------------------------------------ */
+/*  golden files                                                       */
+
+static int put_u32(FILE *f, uint32_t v) { return fwrite(&v, 4, 1, f) == 1 ? 0 : -1; }
+
+static int write_gold(const char *path, const struct scenario *sc)
+{
+    FILE *f = fopen(path, "wb");
+    uint8_t *buf = malloc(DINO_GOLD_MAX);
+    int err = !f || !buf;
+
+    if (!err) {
+        err |= fwrite(DINO_GOLD_MAGIC, 8, 1, f) != 1;
+        err |= put_u32(f, sc->frames);
+        for (unsigned i = 0; i < sc->frames && !err; i++) {
+            size_t n = dino_gold_encode(sc->fb[i], i ? sc->fb[i - 1] : NULL, buf);
+            err |= put_u32(f, (uint32_t)n);
+            err |= fwrite(buf, 1, n, f) != n;
+        }
+    }
+    free(buf);
+    if (f)
+        err |= fclose(f) != 0;
+    return err ? -1 : 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  diffs                                                              */
+
+static int write_ppm(const char *path, const uint8_t *rgb, unsigned w, unsigned h)
+{
+    FILE *f = fopen(path, "wb");
+    int err;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "P6\n%u %u\n255\n", w, h);
+    err = fwrite(rgb, 3, (size_t)w * h, f) != (size_t)w * h;
+    err |= fclose(f) != 0;
+    if (err)
+        perror(path);
+    return err ? -1 : 0;
+}
+
+/* Differing pixels magenta, the rest of the rendered frame dimmed. */
+static void make_diff(const uint8_t *gold, const uint8_t *got, uint8_t *out)
+{
+    for (unsigned i = 0; i < FB_BYTES; i += 3) {
+        if (memcmp(gold + i, got + i, 3)) {
+            out[i] = 255; out[i + 1] = 0; out[i + 2] = 255;
+        } else {
+            out[i] = got[i] / 4; out[i + 1] = got[i + 1] / 4; out[i + 2] = got[i + 2] / 4;
+        }
+    }
+}
+
+struct failure {
+    uint8_t *gold, *got;                // copies, for the montage
+};
+
+static pthread_mutex_t fail_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct failure  montage[MAX_MONTAGE];
+static unsigned        n_montage;
+
+/* The diff image for a failing frame, and a copy for the montage.  0, or
+   -1 with sc->error set if the image can't be written. */
+static int record(const struct job *job, struct scenario *sc, unsigned frame,
+                  const uint8_t *gold, uint8_t *scratch)
+{
+    char path[4096];
+
+    make_diff(gold, sc->fb[frame], scratch);
+    snprintf(path, sizeof path, "%s/%s_%03u.ppm", job->diff_dir, sc->name, frame);
+    if (write_ppm(path, scratch, DINO_SCREEN_W, DINO_SCREEN_H) < 0) {
+        snprintf(sc->error, sizeof sc->error, "can't write %s", path);
+        return -1;
+    }
+
+    pthread_mutex_lock(&fail_lock);
+    if (n_montage < MAX_MONTAGE) {
+        struct failure *m = &montage[n_montage];
+        if ((m->gold = malloc(FB_BYTES)) && (m->got = malloc(FB_BYTES))) {
+            memcpy(m->gold, gold, FB_BYTES);
+            memcpy(m->got, sc->fb[frame], FB_BYTES);
+            n_montage++;
+        }
+    }
+    pthread_mutex_unlock(&fail_lock);
+    return 0;
+}
+
+/* 0 if there was nothing to write or it was written, else -1. */
+static int write_montage(const char *dir)
+{
+    const unsigned hw = DINO_SCREEN_W / 2, hh = DINO_SCREEN_H / 2, w = 3 * hw;
+    uint8_t *img, *diff;
+    char path[4096];
+    int err;
+
+    if (!n_montage)
+        return 0;
+    diff = malloc(FB_BYTES);
+    if (!diff || !(img = malloc((size_t)w * hh * n_montage * 3))) {
+        fprintf(stderr, "no memory for the montage\n");
+        free(diff);
+        return -1;
+    }
+    for (unsigned k = 0; k < n_montage; k++) {
+        const uint8_t *tile[3] = { montage[k].gold, montage[k].got, diff };
+        make_diff(montage[k].gold, montage[k].got, diff);
+        for (unsigned y = 0; y < hh; y++)
+            for (unsigned t = 0; t < 3; t++)
+                for (unsigned x = 0; x < hw; x++)
+                    memcpy(img + 3 * ((size_t)(k * hh + y) * w + t * hw + x),
+                           tile[t] + 3 * (2 * y * DINO_SCREEN_W + 2 * x), 3);
+    }
+    snprintf(path, sizeof path, "%s/montage.ppm", dir);
+    err = write_ppm(path, img, w, hh * n_montage);
+    if (!err)
+        printf("montage of %u failing frames: %s\n", n_montage, path);
+    free(img);
+    free(diff);
+    return err;
+}
+
+/* ------------------------------------------------------------------ */
+/*  one scenario                                                       */
+
+static void compare(const struct job *job, struct scenario *sc, const char *gold_path)
+{
+    FILE *f = fopen(gold_path, "rb");
+    uint8_t *gold = calloc(FB_BYTES, 1), *buf = malloc(DINO_GOLD_MAX);
+    uint8_t *scratch = malloc(FB_BYTES);
+    uint32_t count;
+
+    if (!f || !gold || !buf || !scratch || dino_gold_open(f, &count) < 0) {
+        snprintf(sc->error, sizeof sc->error, "no golden frames in %s", gold_path);
+        goto out;
+    }
+    if (count != sc->frames) {
+        snprintf(sc->error, sizeof sc->error, "%s has %u frames, trace makes %u",
+                 gold_path, count, sc->frames);
+        goto out;
+    }
+    for (unsigned i = 0; i < count; i++) {
+        if (dino_gold_next(f, buf, gold) < 0) {
+            snprintf(sc->error, sizeof sc->error, "%s: frame %u is damaged", gold_path, i);
+            goto out;
+        }
+        if (!memcmp(gold, sc->fb[i], FB_BYTES))
+            continue;
+        unsigned bad = 0;
+        for (unsigned p = 0; p < FB_BYTES; p += 3)
+            bad += memcmp(gold + p, sc->fb[i] + p, 3) != 0;
+        if (!sc->bad_frames++)
+            sc->first_bad = (int)i;
+        sc->bad_pixels += bad;
+        if (record(job, sc, i, gold, scratch) < 0)
+            goto out;
+    }
+out:
+    if (f)
+        fclose(f);
+    free(gold);
+    free(buf);
+    free(scratch);
+}
+
+static void *worker(void *arg)
+{
+    struct job *job = arg;
+    struct dino_render r;
+
+    if (dino_render_init(&r, job->sprites) < 0)
+        return NULL;
+    for (;;) {
+        unsigned i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= job->n)
+            break;
+        struct scenario *sc = job->sc[i];
+        char trace[4096], gold[4096], path[4096];
+        FILE *bus = NULL;
+        int err;
+
+        snprintf(trace, sizeof trace, "%s/%s.trace", job->dir, sc->name);
+        snprintf(gold, sizeof gold, "%s/%s.gold", job->dir, sc->name);
+        if (job->bus_dir) {
+            snprintf(path, sizeof path, "%s/%s.bus", job->bus_dir, sc->name);
+            if (!(bus = fopen(path, "w"))) {
+                snprintf(sc->error, sizeof sc->error, "can't write %s", path);
+                continue;
+            }
+        }
+        err = play(sc, trace, &r, bus);
+        if (bus && fclose(bus) != 0 && !err) {
+            snprintf(sc->error, sizeof sc->error, "can't write %s", path);
+            err = -1;
+        }
+        if (err < 0)
+            continue;
+        if (job->update) {
+            if (write_gold(gold, sc) < 0)
+                snprintf(sc->error, sizeof sc->error, "can't write %s", gold);
+        } else {
+            compare(job, sc, gold);
+        }
+        for (unsigned k = 0; k < sc->frames; k++) {
+            free(sc->fb[k]);
+            sc->fb[k] = NULL;
+        }
+    }
+    dino_render_free(&r);
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+
+/* mkdir -p */
+static int make_dir(const char *dir)
+{
+    char path[4096];
+    size_t len = strlen(dir);
+
+    if (len >= sizeof path)
+        return -1;
+    memcpy(path, dir, len + 1);
+    for (char *p = path + 1; ; p++) {
+        if (*p && *p != '/')
+            continue;
+        char c = *p;
+        *p = 0;
+        if (mkdir(path, 0777) < 0 && errno != EEXIST) {
+            perror(path);
+            return -1;
+        }
+        if (!(*p = c))
+            return 0;
+    }
+}
+
+static int add_scenario(struct job *job, const char *name)
+{
+    struct scenario *sc;
+    size_t len = strlen(name);
+
+    if (len > 6 && !strcmp(name + len - 6, ".trace"))
+        len -= 6;
+    if (job->n == MAX_SCENARIOS || len >= sizeof sc->name || !(sc = calloc(1, sizeof *sc)))
+        return -1;
+    memcpy(sc->name, name, len);
+    sc->first_bad = -1;
+    job->sc[job->n++] = sc;
+    return 0;
+}
+
+static int by_name(const void *a, const void *b)
+{
+    return strcmp((*(struct scenario *const *)a)->name, (*(struct scenario *const *)b)->name);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-d DIR] [-j THREADS] [--hex DIR] [--diff DIR] [--bus DIR] "
+                    "[--update] [SCENARIO]...\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    static struct dino_sprites sprites;
+    static struct job job;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *hex_dir = "hex";
+
+    job.dir = "golden";
+    job.diff_dir = "golden-diff";
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-d") && i + 1 < argc)
+            job.dir = argv[++i];
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            threads = strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--hex") && i + 1 < argc)
+            hex_dir = argv[++i];
+        else if (!strcmp(argv[i], "--diff") && i + 1 < argc)
+            job.diff_dir = argv[++i];
+        else if (!strcmp(argv[i], "--bus") && i + 1 < argc)
+            job.bus_dir = argv[++i];
+        else if (!strcmp(argv[i], "--update"))
+            job.update = 1;
+        else if (argv[i][0] != '-' && add_scenario(&job, argv[i]) == 0)
+            ;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+
+    if (!job.n) {
+        DIR *d = opendir(job.dir);
+        struct dirent *e;
+        if (!d) {
+            perror(job.dir);
+            return 1;
+        }
+        while ((e = readdir(d))) {
+            size_t len = strlen(e->d_name);
+            if (len > 6 && !strcmp(e->d_name + len - 6, ".trace"))
+                add_scenario(&job, e->d_name);
+        }
+        closedir(d);
+        qsort(job.sc, job.n, sizeof job.sc[0], by_name);
+    }
+    if (dino_sprites_load(&sprites, hex_dir) < 0)
+        return 1;
+    if (job.bus_dir && make_dir(job.bus_dir) < 0)
+        return 1;
+    if (!job.update && make_dir(job.diff_dir) < 0)
+        return 1;
+    job.sprites = &sprites;
+
+    pthread_t tid[threads];
+    double t0 = now_s();
+    for (long t = 0; t < threads; t++)
+        pthread_create(&tid[t], NULL, worker, &job);
+    for (long t = 0; t < threads; t++)
+        pthread_join(tid[t], NULL);
+    double dt = now_s() - t0;
+
+    unsigned frames = 0, failed = 0;
+    for (unsigned i = 0; i < job.n; i++) {
+        const struct scenario *sc = job.sc[i];
+        frames += sc->frames;
+        if (sc->error[0]) {
+            printf("%-12s ERROR  %s\n", sc->name, sc->error);
+            failed++;
+        } else if (sc->bad_frames) {
+            printf("%-12s FAIL   %u of %u frames differ (first %d), %llu pixels\n", sc->name,
+                   sc->bad_frames, sc->frames, sc->first_bad, (unsigned long long)sc->bad_pixels);
+            failed++;
+        } else {
+            printf("%-12s %s %u frames\n", sc->name, job.update ? "WROTE " : "ok    ",
+                   sc->frames);
+        }
+    }
+    int montage_err = write_montage(job.diff_dir);
+    printf("%u scenarios, %u frames in %.2f s on %ld threads: %u failed\n",
+           job.n, frames, dt, threads, failed);
+    return failed != 0 || montage_err;
+}
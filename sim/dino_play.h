@@ -0,0 +1,54 @@
+#ifndef DINO_PLAY_H
+#define DINO_PLAY_H
+
+#include <stdbool.h>
+#include "dino_sim.h"
+#include "../controller/dino_physics.h"
+
+/* dino_sim driven the way dinofinals3.c drives the board: every physics
+ * step moves the dino and writes DINO_X/DINO_Y, and the game runs until
+ * the next write.  One call is one motion period, ending on the motion
+ * update, so DINO_PLAY_SUBSTEPS physics steps per call.
+ */
+
+#define DINO_PLAY_CYCLES_PER_PHYSICS  (50000000u / PHYSICS_HZ)
+#define DINO_PLAY_SUBSTEPS            (DINO_MOTION_PERIOD / DINO_PLAY_CYCLES_PER_PHYSICS)
+
+/* One physics step.  *phase is the step's place in the motion period
+   (0 .. DINO_PLAY_SUBSTEPS-1); the last one ends on the motion update. */
+static inline void dino_play_step(struct dino_state *s, struct dino *d, bool jump,
+                                  unsigned *phase)
+{
+    uint32_t len = *phase == DINO_PLAY_SUBSTEPS - 1
+                 ? DINO_MOTION_PERIOD - *phase * DINO_PLAY_CYCLES_PER_PHYSICS
+                 : DINO_PLAY_CYCLES_PER_PHYSICS;
+
+    physics_step(d, jump && d->y_fixed == GROUND_Y_FIXED);
+    dino_sim_write(s, DINO_REG_DINO_X, (uint32_t)d->x);
+    dino_sim_write(s, DINO_REG_DINO_Y, (uint32_t)(d->y_fixed >> FIXED_SHIFT));
+    dino_sim_run(s, len);
+
+    if (++*phase == DINO_PLAY_SUBSTEPS)
+        *phase = 0;
+}
+
+/* A whole motion period with the button held (or not) throughout. */
+static inline void dino_play_tick(struct dino_state *s, struct dino *d, bool jump)
+{
+    unsigned phase = 0;
+
+    do
+        dino_play_step(s, d, jump, &phase);
+    while (phase);
+}
+
+/* Replay after a game over, with the dino back at the start. */
+static inline void dino_play_replay(struct dino_state *s, struct dino *d)
+{
+    dino_sim_write(s, DINO_REG_REPLAY, 1);
+    dino_sim_run(s, 1);
+    dino_sim_write(s, DINO_REG_REPLAY, 0);
+    *d = (struct dino){ .x = 100, .y_fixed = GROUND_Y_FIXED };
+}
+
+#endif
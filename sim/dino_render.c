@@ -0,0 +1,523 @@
+/*  dino_render.c – final/staged/vga_ball.sv's frame, drawn in software */
+
+#include "dino_render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define W        DINO_SCREEN_W
+#define H        DINO_SCREEN_H
+#define ROW      (W * 3)
+
+const char *const dino_rom_name[DINO_N_ROMS] = {
+    [DINO_ROM_S_CAC]    = "S_CAC",
+    [DINO_ROM_GROUP]    = "GROUP",
+    [DINO_ROM_LAVA]     = "LAVA",
+    [DINO_ROM_PTR_DOWN] = "PTR_DOWN",
+    [DINO_ROM_PTR_UP]   = "PTR_UP",
+    [DINO_ROM_DINO]     = "DINO",
+    [DINO_ROM_DUCK]     = "DUCK",
+    [DINO_ROM_JUMP]     = "JUMP",
+    [DINO_ROM_LEFT]     = "LEFT_LEG",
+    [DINO_ROM_RIGHT]    = "RIGHT_LEG",
+    [DINO_ROM_POWERUP]  = "POWERUP",
+    [DINO_ROM_GODZILLA] = "GODZILLA",
+    [DINO_ROM_REPLAY]   = "REPLAY",
+};
+
+/* ------------------------------------------------------------------ */
+/*  the atlas                                                          */
+
+/* $readmemh: hex words separated by white space, // comments, @address.
+   Words past the end of the file stay 0 (--x-initial 0). */
+static int read_hex(const char *path, uint32_t *mem, unsigned size)
+{
+    FILE *f = fopen(path, "r");
+    unsigned at = 0;
+    int c;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    memset(mem, 0, size * sizeof *mem);
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '/') {
+            while ((c = fgetc(f)) != EOF && c != '\n')
+                ;
+        } else if (c == '@') {
+            unsigned a;
+            if (fscanf(f, "%x", &a) == 1)
+                at = a;
+        } else if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+            unsigned v;
+            ungetc(c, f);
+            if (fscanf(f, "%x", &v) == 1 && at < size)
+                mem[at] = v;
+            at++;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+/* The values of a "... = '{11'd226, 11'd431, ...};" array, at most max. */
+static unsigned read_array(const char *line, unsigned *dest, unsigned max)
+{
+    unsigned n = 0;
+
+    for (const char *p = strchr(line, '='); p && (p = strstr(p, "'d")); p += 2)
+        if (n < max)
+            dest[n++] = (unsigned)strtoul(p + 2, NULL, 10);
+    return n;
+}
+
+/* The "localparam logic [13:0] ATLAS_NAME = 14'dBASE;" and
+   "localparam logic [3:0] PAL_NAME = 4'dN;" lines, SPRITE_IDS with the
+   SPRITE_BASE, SPRITE_WIDTH and SPRITE_WRAP arrays, and the PAL_BASE and
+   PAL_MASK arrays. */
+static int read_offsets(const char *path, struct dino_sprites *sp)
+{
+    static const char *const arrays[] = { "SPRITE_BASE", "SPRITE_WIDTH", "SPRITE_WRAP",
+                                          "PAL_BASE", "PAL_MASK" };
+    unsigned *dest[] = { sp->id_base, sp->id_width, sp->id_wrap, sp->pal_base, sp->pal_mask };
+    unsigned count[5] = { 0 };
+    FILE *f = fopen(path, "r");
+    char line[1024], name[32];
+    unsigned hi, lo, bits, value;
+    int found[2] = { 0, 0 }, have_n = 0;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof line, f)) {
+        int pal;
+        if (sscanf(line, "localparam int SPRITE_IDS = %u", &sp->n_ids) == 1)
+            have_n = 1;
+        if (sscanf(line, "localparam logic [%u:%u] %31[A-Z_]", &hi, &lo, name) == 3)
+            for (int i = 0; i < 5; i++)
+                if (!strcmp(name, arrays[i]))
+                    count[i] = read_array(line, dest[i], i < 3 ? DINO_MAX_IDS : DINO_PALETTES);
+        if (sscanf(line, "localparam logic [%u:%u] ATLAS_%31s = %u'd%u", &hi, &lo, name,
+                   &bits, &value) == 5)
+            pal = 0;
+        else if (sscanf(line, "localparam logic [%u:%u] PAL_%31s = %u'd%u", &hi, &lo, name,
+                        &bits, &value) == 5)
+            pal = 1;
+        else
+            continue;
+        for (int i = 0; i < DINO_N_ROMS; i++)
+            if (!strcmp(name, dino_rom_name[i])) {
+                (pal ? sp->pal : sp->base)[i] = value;
+                found[pal] |= 1 << i;
+            }
+    }
+    fclose(f);
+
+    for (int i = 0; i < DINO_N_ROMS; i++)
+        for (int pal = 0; pal < 2; pal++)
+            if (!(found[pal] & 1 << i)) {
+                fprintf(stderr, "%s: no %s%s\n", path, pal ? "PAL_" : "ATLAS_",
+                        dino_rom_name[i]);
+                return -1;
+            }
+    if (!have_n || sp->n_ids > DINO_MAX_IDS) {
+        fprintf(stderr, "%s: no SPRITE_IDS, or more than %d\n", path, DINO_MAX_IDS);
+        return -1;
+    }
+    for (int i = 0; i < 5; i++)
+        if (count[i] != (i < 3 ? sp->n_ids : DINO_PALETTES)) {
+            fprintf(stderr, "%s: %s has %u values\n", path, arrays[i], count[i]);
+            return -1;
+        }
+    for (unsigned id = 0; id < sp->n_ids; id++)
+        if (sp->id_width[id] % 2 || sp->id_base[id] + sp->id_wrap[id] >= DINO_ATLAS_WORDS) {
+            fprintf(stderr, "%s: sprite %u doesn't fit\n", path, id);
+            return -1;
+        }
+    for (unsigned p = 0; p < DINO_PALETTES; p++)
+        if (sp->pal_base[p] + sp->pal_mask[p] >= DINO_PALETTE_WORDS ||
+            sp->pal_base[p] & sp->pal_mask[p]) {
+            fprintf(stderr, "%s: palette %u doesn't fit\n", path, p);
+            return -1;
+        }
+    return 0;
+}
+
+/* sky.svh: "localparam int CLOUDS = N;", SUN_X and SUN_Y, and the
+   CLOUD_X, CLOUD_Y and CLOUD_GREY arrays ("'{11'd226, ...}"). */
+static int read_sky(const char *path, struct dino_sprites *sp)
+{
+    static const char *const names[] = { "SUN_X", "SUN_Y", "CLOUD_X", "CLOUD_Y", "CLOUD_GREY" };
+    unsigned *dest[] = { &sp->sun_x, &sp->sun_y, sp->cloud_x, sp->cloud_y, sp->cloud_grey };
+    unsigned count[5] = { 0 };
+    FILE *f = fopen(path, "r");
+    char line[256], name[32];
+    unsigned hi, lo;
+    int have_n = 0;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof line, f)) {
+        if (sscanf(line, "localparam int CLOUDS = %u", &sp->n_clouds) == 1)
+            have_n = 1;
+        if (sscanf(line, "localparam logic [%u:%u] %31[A-Z_]", &hi, &lo, name) != 3)
+            continue;
+        for (int i = 0; i < 5; i++)
+            if (!strcmp(name, names[i]))
+                count[i] = read_array(line, dest[i], i < 2 ? 1 : DINO_MAX_CLOUDS);
+    }
+    fclose(f);
+
+    if (!have_n || sp->n_clouds > DINO_MAX_CLOUDS) {
+        fprintf(stderr, "%s: no CLOUDS, or more than %d\n", path, DINO_MAX_CLOUDS);
+        return -1;
+    }
+    for (int i = 0; i < 5; i++)
+        if (count[i] != (i < 2 ? 1 : sp->n_clouds)) {
+            fprintf(stderr, "%s: %s has %u values\n", path, names[i], count[i]);
+            return -1;
+        }
+    for (unsigned k = 0; k < sp->n_clouds; k++)
+        if (sp->cloud_x[k] > DINO_SCREEN_W - 64) {
+            fprintf(stderr, "%s: cloud %u off the screen\n", path, k);
+            return -1;
+        }
+    return 0;
+}
+
+int dino_sprites_load(struct dino_sprites *sp, const char *dir)
+{
+    static uint32_t words[DINO_ATLAS_WORDS];
+    char path[4096];
+
+    snprintf(path, sizeof path, "%s/sprite_atlas.hex", dir);
+    if (read_hex(path, words, DINO_ATLAS_WORDS) < 0)
+        return -1;
+    for (int i = 0; i < DINO_ATLAS_WORDS; i++)
+        sp->atlas[i] = words[i] & 0x1FF;
+    snprintf(path, sizeof path, "%s/sprite_mask.hex", dir);
+    if (read_hex(path, sp->mask, DINO_ATLAS_WORDS / 32) < 0)
+        return -1;
+    snprintf(path, sizeof path, "%s/sprite_palette.hex", dir);
+    if (read_hex(path, words, DINO_PALETTE_WORDS) < 0)
+        return -1;
+    for (int i = 0; i < DINO_PALETTE_WORDS; i++)
+        sp->palette[i] = (uint16_t)words[i];
+    snprintf(path, sizeof path, "%s/sky_mask.hex", dir);
+    if (read_hex(path, sp->sky, DINO_SKY_WORDS) < 0)
+        return -1;
+    snprintf(path, sizeof path, "%s/sky.svh", dir);
+    if (read_sky(path, sp) < 0)
+        return -1;
+    snprintf(path, sizeof path, "%s/sprite_atlas.svh", dir);
+    return read_offsets(path, sp);
+}
+
+/* ------------------------------------------------------------------ */
+/*  fixed layers                                                       */
+
+static inline void put(uint8_t *p, uint8_t r, uint8_t g, uint8_t b)
+{
+    p[0] = r; p[1] = g; p[2] = b;
+}
+
+/* Everything up to the clouds, plus the birds and rocks that are drawn
+   after them (birds get redrawn over any cloud, see draw_clouds()). */
+static void build_sky(uint8_t *fb, const struct dino_sprites *sp, int night)
+{
+    const uint8_t sky[3] = { night ? 10 : 135, night ? 10 : 206, night ? 40 : 235 };
+    const uint8_t sun[3] = { 255, 255, night ? 255 : 0 };
+
+    for (int v = 0; v < H; v++) {
+        uint8_t *p = fb + v * ROW;
+        for (int h = 0; h < W; h++, p += 3) {
+            if (v < 280)      put(p, sky[0], sky[1], sky[2]);
+            else if (v > 300) put(p, 100, 40, 10);
+            else              put(p, 139, 69, 19);
+            if (v == 280)
+                put(p, 0, 0, 0);
+
+            unsigned dh = (unsigned)abs(h - (int)sp->sun_x);
+            unsigned dv = (unsigned)abs(v - (int)sp->sun_y);
+            if (dh < 64 && dv < 64 && dino_sky_covered(sp, 0, dv, dh))
+                put(p, sun[0], sun[1], sun[2]);
+
+            if (((h > 300 && h < 305) && v == 50) || ((h > 305 && h < 310) && v == 51) ||
+                ((h > 310 && h < 315) && v == 50) || ((h > 600 && h < 605) && v == 80) ||
+                ((h > 605 && h < 610) && v == 81) || ((h > 610 && h < 615) && v == 80))
+                put(p, 0, 0, 0);
+
+            if (v > 280 && v < 480 &&
+                ((h % 120 == 0 && v % 50 < 10) || (h % 200 == 15 && v % 60 < 8)))
+                put(p, 110, 50, 10);
+        }
+    }
+}
+
+static const struct { int16_t v, lo, hi; } birds[] = {
+    { 50, 301, 304 }, { 50, 311, 314 }, { 51, 306, 309 },
+    { 80, 601, 604 }, { 80, 611, 614 }, { 81, 606, 609 },
+};
+
+/* Cloud k's tile as spans per row. */
+static int build_cloud(struct dino_render *r, const struct dino_sprites *sp, unsigned k)
+{
+    for (int v = 0; v < H; v++) {
+        uint8_t cover[W + 65] = { 0 };
+        unsigned row = (unsigned)v - sp->cloud_y[k];
+        int n = 0;
+
+        if (row < 64)
+            for (unsigned col = 0; col < 64; col++)
+                cover[sp->cloud_x[k] + col] = (uint8_t)dino_sky_covered(sp, 1 + k, row, col);
+        for (int h = 0; h < W + 64; h++)
+            if (cover[h] && (h == 0 || !cover[h - 1]))
+                n++;
+        r->n_cloud[k][v] = (uint8_t)n;
+        r->cloud[k][v] = NULL;
+        if (!n)
+            continue;
+        if (!(r->cloud[k][v] = malloc(n * sizeof(struct dino_span))))
+            return -1;
+        n = 0;
+        for (int h = 0; h < W + 64; h++) {
+            if (cover[h] && (h == 0 || !cover[h - 1]))
+                r->cloud[k][v][n].lo = (int16_t)h;
+            if (cover[h] && !cover[h + 1])
+                r->cloud[k][v][n++].hi = (int16_t)h;
+        }
+    }
+    return 0;
+}
+
+int dino_render_init(struct dino_render *r, const struct dino_sprites *sp)
+{
+    memset(r, 0, sizeof *r);
+    r->sky[0] = malloc((size_t)ROW * H);
+    r->sky[1] = malloc((size_t)ROW * H);
+    r->over   = malloc((size_t)ROW * H);
+    if (!r->sky[0] || !r->sky[1] || !r->over)
+        goto fail;
+
+    build_sky(r->sky[0], sp, 0);
+    build_sky(r->sky[1], sp, 1);
+    for (int i = 0; i < W * H; i++)
+        put(r->over + 3 * i, 135, 206, 235);
+    r->n_clouds = sp->n_clouds;
+    for (unsigned k = 0; k < sp->n_clouds; k++) {
+        r->cloud_grey[k] = (uint8_t)sp->cloud_grey[k];
+        if (build_cloud(r, sp, k) < 0)
+            goto fail;
+    }
+
+    memcpy(r->atlas, sp->atlas, sizeof r->atlas);
+    for (unsigned a = 0; a < DINO_ATLAS_WORDS; a++)
+        r->opaque[a] = dino_sprite_opaque(sp, a);
+    memcpy(r->palette, sp->palette, sizeof r->palette);
+    memcpy(r->pal, sp->pal, sizeof r->pal);
+    memcpy(r->pal_base, sp->pal_base, sizeof r->pal_base);
+    memcpy(r->pal_mask, sp->pal_mask, sizeof r->pal_mask);
+    r->n_ids = sp->n_ids;
+    memcpy(r->id_base, sp->id_base, sizeof r->id_base);
+    memcpy(r->id_width, sp->id_width, sizeof r->id_width);
+    memcpy(r->id_wrap, sp->id_wrap, sizeof r->id_wrap);
+    dino_render_reset(r);
+    return 0;
+
+fail:
+    dino_render_free(r);
+    return -1;
+}
+
+void dino_render_free(struct dino_render *r)
+{
+    free(r->sky[0]);
+    free(r->sky[1]);
+    free(r->over);
+    for (int k = 0; k < DINO_MAX_CLOUDS; k++)
+        for (int v = 0; v < H; v++)
+            free(r->cloud[k][v]);
+    memset(r, 0, sizeof *r);
+}
+
+void dino_render_palette(struct dino_render *r, unsigned entry, uint16_t px)
+{
+    entry %= DINO_PALETTE_WORDS;
+    put(r->rgb[entry], (uint8_t)((px >> 11) << 3), (uint8_t)(((px >> 5) & 0x3F) << 2),
+        (uint8_t)((px & 0x1F) << 3));
+}
+
+void dino_render_oam(struct dino_render *r, unsigned word, uint32_t value)
+{
+    word %= 2 * DINO_OAM_ENTRIES;
+    r->oam[word] = value & (word & 1 ? 0xFFFF : 0x3FFFFFF);
+}
+
+void dino_render_reset(struct dino_render *r)
+{
+    for (unsigned i = 0; i < DINO_PALETTE_WORDS; i++)
+        dino_render_palette(r, i, r->palette[i]);
+    memset(r->oam, 0, sizeof r->oam);
+}
+
+/* ------------------------------------------------------------------ */
+/*  per frame                                                          */
+
+static void fill(uint8_t *row, int lo, int hi, uint8_t g)
+{
+    if (lo < 0) lo = 0;
+    if (hi > W - 1) hi = W - 1;
+    if (lo <= hi)
+        memset(row + 3 * lo, g, 3 * (size_t)(hi - lo + 1));
+}
+
+static void draw_clouds(const struct dino_render *r, uint8_t *fb, int offset)
+{
+    /* each cloud is also drawn 1280 to the left, so it wraps back in */
+    for (unsigned k = 0; k < r->n_clouds; k++)
+        for (int v = 0; v < H; v++)
+            for (int i = 0; i < r->n_cloud[k][v]; i++) {
+                const struct dino_span *sp = &r->cloud[k][v][i];
+                fill(fb + v * ROW, sp->lo + offset, sp->hi + offset, r->cloud_grey[k]);
+                fill(fb + v * ROW, sp->lo + offset - 1280, sp->hi + offset - 1280,
+                     r->cloud_grey[k]);
+            }
+    for (unsigned i = 0; i < sizeof birds / sizeof birds[0]; i++)
+        fill(fb + birds[i].v * ROW, birds[i].lo, birds[i].hi, 0);
+}
+
+struct object {
+    unsigned x, y, id, pal, prio;
+    int      on, flip;
+};
+
+/* The objects in the engine's order: the game's seven from its registers,
+   then the OAM's 64. */
+static void objects(const struct dino_render *r, const struct dino_state *s,
+                    struct object *o)
+{
+    int dino_rom = s->godzilla_mode ? DINO_ROM_GODZILLA
+                 : s->ducking       ? DINO_ROM_DUCK
+                 : s->jumping       ? DINO_ROM_JUMP
+                 : s->sprite_state == 1 ? DINO_ROM_LEFT
+                 : s->sprite_state == 2 ? DINO_ROM_RIGHT
+                 : DINO_ROM_DINO;
+    const struct { int rom; unsigned x, y; } game[DINO_GAME_OBJECTS] = {
+        { DINO_ROM_REPLAY,  560,          200 },
+        { s->sprite_state == 1 ? DINO_ROM_PTR_UP : DINO_ROM_PTR_DOWN, s->ptr_x, s->ptr_y },
+        { DINO_ROM_LAVA,    s->lava_x,    s->lava_y },
+        { DINO_ROM_GROUP,   s->group_x,   s->group_y },
+        { DINO_ROM_S_CAC,   s->s_cac_x,   s->s_cac_y },
+        { dino_rom,         s->dino_x,    s->dino_y },
+        { DINO_ROM_POWERUP, s->powerup_x, s->powerup_y },
+    };
+
+    for (int i = 0; i < DINO_GAME_OBJECTS; i++) {
+        unsigned id = r->pal[game[i].rom];
+        o[i] = (struct object){ game[i].x, game[i].y, id, id, DINO_GAME_PRIORITY,
+                                i == 0 ? s->game_over : !s->game_over, i == 1 };
+    }
+    for (int e = 0; e < DINO_OAM_ENTRIES; e++) {
+        uint32_t pos = r->oam[2 * e], attr = r->oam[2 * e + 1];
+        o[DINO_GAME_OBJECTS + e] = (struct object){
+            pos & 0x7FF, pos >> 16 & 0x3FF, attr & 15, attr >> 4 & 15, attr >> 9 & 7,
+            attr >> 15 & 1, attr >> 8 & 1 };
+    }
+}
+
+/* Each line as the engine fills its buffer: objects in order, two clocks
+   each and half the width more for one on the line, pairs past clock
+   HTOTAL - 3 dropped; a pixel takes an opaque one over an empty slot or a
+   higher priority number. */
+static void draw_objects(const struct dino_render *r, const struct dino_state *s, uint8_t *fb)
+{
+    struct object o[DINO_OBJECTS];
+    uint8_t tag[W];                     // priority + 1 (0 = empty)
+    uint16_t px[W];                     // palette RAM address
+
+    objects(r, s, o);
+    memset(tag, 0, sizeof tag);
+    for (unsigned v = 0; v < H; v++) {
+        unsigned t = 0, lo = W, hi = 0;
+
+        for (int i = 0; i < DINO_OBJECTS; i++) {
+            const struct object *ob = &o[i];
+            if (!ob->on || ob->id >= r->n_ids || v < ob->y || v >= ob->y + 32) {
+                t += 2;
+                continue;
+            }
+
+            unsigned w = r->id_width[ob->id], base = r->id_base[ob->id];
+            unsigned wrap = r->id_wrap[ob->id], row = (v - ob->y) * w;
+            unsigned pal_base = r->pal_base[ob->pal], pal_mask = r->pal_mask[ob->pal];
+            unsigned pairs = t + 4 < DINO_SCREEN_HTOTAL ? DINO_SCREEN_HTOTAL - 4 - t : 0;
+            unsigned cols = 2 * pairs < w ? 2 * pairs : w;  // pair j is clock t + 2 + j
+
+            if (ob->x + cols > W)
+                cols = ob->x < W ? W - ob->x : 0;
+            t += 2 + w / 2;
+            if (cols && ob->x < lo) lo = ob->x;
+            if (cols && ob->x + cols > hi) hi = ob->x + cols;
+
+            for (unsigned col = 0; col < cols; col++) {
+                unsigned a = base + ((row + (ob->flip ? w - 1 - col : col)) & wrap);
+                unsigned x = ob->x + col;
+                if (r->opaque[a] && (!tag[x] || ob->prio + 1 < tag[x])) {
+                    tag[x] = (uint8_t)(ob->prio + 1);
+                    px[x]  = (uint16_t)(pal_base | (r->atlas[a] & pal_mask));
+                }
+            }
+        }
+
+        uint8_t *p = fb + v * ROW;
+        for (unsigned x = lo; x < hi; x++)
+            if (tag[x]) {
+                put(p + 3 * x, r->rgb[px[x]][0], r->rgb[px[x]][1], r->rgb[px[x]][2]);
+                tag[x] = 0;
+            }
+    }
+}
+
+static const uint8_t font[10][8] = {
+    {0x3C,0x66,0x6E,0x7E,0x76,0x66,0x3C,0x00}, {0x18,0x38,0x18,0x18,0x18,0x18,0x7E,0x00},
+    {0x3C,0x66,0x06,0x1C,0x30,0x66,0x7E,0x00}, {0x3C,0x66,0x06,0x1C,0x06,0x66,0x3C,0x00},
+    {0x0C,0x1C,0x2C,0x4C,0x7E,0x0C,0x0C,0x00}, {0x7E,0x60,0x7C,0x06,0x06,0x66,0x3C,0x00},
+    {0x3C,0x66,0x60,0x7C,0x66,0x66,0x3C,0x00}, {0x7E,0x06,0x0C,0x18,0x30,0x30,0x30,0x00},
+    {0x3C,0x66,0x66,0x3C,0x66,0x66,0x3C,0x00}, {0x3C,0x66,0x66,0x3E,0x06,0x66,0x3C,0x00},
+};
+
+#define SCORE_X  120
+#define SCORE_Y  10
+
+static void draw_score(uint8_t *fb, const uint8_t *bcd)
+{
+    for (int ry = 0; ry < 8; ry++) {
+        uint8_t *row = fb + (SCORE_Y + ry) * ROW;
+        for (int idx = 0; idx < DINO_N_DIGITS; idx++) {
+            unsigned d = bcd[DINO_N_DIGITS - 1 - idx];
+            if (d > 9)
+                continue;
+            for (int cx = 0; cx < 8; cx++)
+                if (font[d][ry] & (0x80 >> cx))
+                    put(row + 3 * (SCORE_X + idx * 8 + cx), 0, 0, 0);
+        }
+    }
+}
+
+void dino_render_frame(struct dino_render *r, const struct dino_state *s, uint8_t *fb)
+{
+    if (s->game_over) {
+        memcpy(fb, r->over, (size_t)ROW * H);
+        draw_objects(r, s, fb);
+        return;
+    }
+
+    memcpy(fb, r->sky[s->night_time ? 1 : 0], (size_t)ROW * H);
+    draw_clouds(r, fb, s->cloud_offset);
+    draw_objects(r, s, fb);
+    draw_score(fb, s->bcd);
+}
@@ -0,0 +1,156 @@
+#ifndef DINO_RENDER_H
+#define DINO_RENDER_H
+
+#include <stdint.h>
+#include "dino_sim.h"
+
+/* Software copy of final/staged/vga_ball.sv's pixel pipeline (the board's
+ * vga_ball.sv still has a ROM per sprite).
+ *
+ * Produces the 1280x480 RGB frame the RTL puts on VGA_R/G/B for a game
+ * state that holds still for the whole frame, byte for byte, quirks
+ * included:
+ *
+ *   - sprites are objects drawn a line ahead into a line buffer: the
+ *     game's seven, then the 64 OAM entries, two clocks each plus half
+ *     the width of those on the line, and pixel pairs not issued by
+ *     clock HTOTAL - 3 of the line are dropped;
+ *   - a lower priority number is in front, ties go to the lower object;
+ *   - transparency is the atlas's mask plane, whatever the palette says;
+ *   - an object drawn through another sprite's palette takes its indices
+ *     masked to that palette's size (PAL_MASK);
+ *   - the 160-wide replay banner has 1024 words in the atlas, so its
+ *     address wraps every 6.4 rows;
+ *   - the sun is "< 1200 and > 900" or "< 900", so d^2 == 900 stays sky
+ *     (sky.py rasterizes it that way into sky_mask.hex);
+ *   - the pterodactyl is wing-up in sprite_state 1 and wing-down in the
+ *     other three (the old per-sprite ROMs were wired crosswise);
+ *   - a bcd digit that reads 10 (the carry lag) draws nothing.
+ *
+ * The fixed layers (bands, ground line, sun/moon, birds, rocks) are
+ * prebuilt per day/night and copied a row at a time; clouds are span
+ * lists taken from their tiles, shifted by cloud_offset; objects go
+ * through a line of priorities, RGB888 tables over the palettes and the
+ * mask unpacked a byte per pixel.
+ */
+
+#define DINO_SCREEN_W      1280
+#define DINO_SCREEN_H      480
+#define DINO_SCREEN_HTOTAL 1600
+#define DINO_SCREEN_VTOTAL 525
+
+/* The sprites in the atlas (final/staged/sprite_atlas.hex, packed by atlas.py). */
+enum dino_rom {
+    DINO_ROM_S_CAC, DINO_ROM_GROUP, DINO_ROM_LAVA,
+    DINO_ROM_PTR_DOWN, DINO_ROM_PTR_UP,
+    DINO_ROM_DINO, DINO_ROM_DUCK, DINO_ROM_JUMP, DINO_ROM_LEFT, DINO_ROM_RIGHT,
+    DINO_ROM_POWERUP, DINO_ROM_GODZILLA, DINO_ROM_REPLAY,
+    DINO_N_ROMS
+};
+
+#define DINO_ATLAS_WORDS   16384
+#define DINO_PALETTE_WORDS 2048             // the palette RAM, all 16 palettes
+#define DINO_PALETTES      16
+#define DINO_REG_PAL_ADDR  256              // bus address: sets the RAM address,
+#define DINO_REG_PAL_DATA  257              //   writes a colour there and steps on
+#define DINO_REG_OAM       128              // bus address of OAM entry 0, word 0
+#define DINO_OAM_ENTRIES   64               // two words each, see below
+#define DINO_GAME_OBJECTS  7                // ahead of the OAM's, at
+#define DINO_GAME_PRIORITY 4                //   this priority
+#define DINO_OBJECTS       (DINO_GAME_OBJECTS + DINO_OAM_ENTRIES)
+#define DINO_MAX_IDS       16
+#define DINO_SKY_WORDS     1024             // 8 tiles of 64x64 bits
+#define DINO_MAX_CLOUDS    7                // a tile each; tile 0 is the sun
+
+struct dino_sprites {
+    uint16_t  atlas[DINO_ATLAS_WORDS];      // indices, as in sprite_atlas.hex
+    uint32_t  mask[DINO_ATLAS_WORDS / 32];  // sprite_mask.hex: bit a % 32 of word a / 32
+    uint16_t  palette[DINO_PALETTE_WORDS];  // RGB565, sprite_palette.hex
+    unsigned  base[DINO_N_ROMS];            // offsets from sprite_atlas.svh
+    unsigned  pal[DINO_N_ROMS];             // palette numbers from there too
+    unsigned  pal_base[DINO_PALETTES];      // by palette number: PAL_BASE
+    unsigned  pal_mask[DINO_PALETTES];      //   and PAL_MASK
+    unsigned  n_ids;                        // by sprite id (= palette number):
+    unsigned  id_base[DINO_MAX_IDS];        //   SPRITE_BASE,
+    unsigned  id_width[DINO_MAX_IDS];       //   SPRITE_WIDTH
+    unsigned  id_wrap[DINO_MAX_IDS];        //   and SPRITE_WRAP
+
+    uint32_t  sky[DINO_SKY_WORDS];          // sky_mask.hex: the sun and cloud tiles
+    unsigned  sun_x, sun_y;                 // from sky.svh
+    unsigned  n_clouds;
+    unsigned  cloud_x[DINO_MAX_CLOUDS], cloud_y[DINO_MAX_CLOUDS];
+    unsigned  cloud_grey[DINO_MAX_CLOUDS];
+};
+
+/* The name each sprite has in sprite_atlas.svh, less ATLAS_ or PAL_. */
+extern const char *const dino_rom_name[DINO_N_ROMS];
+
+/* Reads sprite_atlas.hex, sprite_mask.hex, sprite_palette.hex,
+   sky_mask.hex ($readmemh format), sprite_atlas.svh and sky.svh from
+   dir.  0 on success; otherwise -1 with the reason on stderr. */
+int dino_sprites_load(struct dino_sprites *sp, const char *dir);
+
+/* Whether atlas address a is drawn.  A mask word is a row of a 32-wide
+   sprite, so sprites can also be tested against each other a row at a
+   time (collision) with shifts and ANDs. */
+static inline int dino_sprite_opaque(const struct dino_sprites *sp, unsigned a)
+{
+    return sp->mask[a / 32] >> (a % 32) & 1;
+}
+
+/* Whether (col, row) of sky tile t is covered: t = 0 is the sun by
+   |dx|, |dy|, t = 1 + k cloud k from its corner. */
+static inline int dino_sky_covered(const struct dino_sprites *sp, unsigned t,
+                                   unsigned row, unsigned col)
+{
+    unsigned a = t * 4096 + row * 64 + col;
+    return sp->sky[a / 32] >> (a % 32) & 1;
+}
+
+/* An OAM entry, as written to DINO_REG_OAM + 2 * entry and the word after. */
+#define DINO_OAM_POS(x, y)  (((uint32_t)(x) & 0x7FF) | ((uint32_t)(y) & 0x3FF) << 16)
+#define DINO_OAM_ATTR(id, pal, flip, prio) \
+    (((uint32_t)(id) & 15) | ((uint32_t)(pal) & 15) << 4 | ((flip) ? 1u << 8 : 0) | \
+     ((uint32_t)(prio) & 7) << 9 | 1u << 15)
+
+struct dino_span { int16_t lo, hi; };       // inclusive
+
+struct dino_render {
+    uint8_t  *sky[2];                       // day, night: fixed layers, W*H*3
+    uint8_t  *over;                         // game over background
+    uint16_t  atlas[DINO_ATLAS_WORDS];
+    uint16_t  palette[DINO_PALETTE_WORDS];  // as at power-on
+    uint8_t   opaque[DINO_ATLAS_WORDS];     // the mask, a byte per pixel
+    uint8_t   rgb[DINO_PALETTE_WORDS][3];   // as the palette RAM holds now
+    unsigned  pal[DINO_N_ROMS];
+    unsigned  pal_base[DINO_PALETTES], pal_mask[DINO_PALETTES];
+    unsigned  n_ids, id_base[DINO_MAX_IDS], id_width[DINO_MAX_IDS], id_wrap[DINO_MAX_IDS];
+    uint32_t  oam[2 * DINO_OAM_ENTRIES];    // as the bus wrote it
+
+    /* cloud k's spans on row v with cloud_offset 0 */
+    unsigned  n_clouds;
+    uint8_t   cloud_grey[DINO_MAX_CLOUDS];
+    struct dino_span *cloud[DINO_MAX_CLOUDS][DINO_SCREEN_H];
+    uint8_t   n_cloud[DINO_MAX_CLOUDS][DINO_SCREEN_H];
+};
+
+int  dino_render_init(struct dino_render *r, const struct dino_sprites *sp);
+void dino_render_free(struct dino_render *r);
+
+/* A write to palette RAM word entry: colour i of palette p is
+   pal_base[p] | (i & pal_mask[p]). */
+void dino_render_palette(struct dino_render *r, unsigned entry, uint16_t rgb565);
+
+/* A bus write to OAM word i (entry i / 2). */
+void dino_render_oam(struct dino_render *r, unsigned word, uint32_t value);
+
+/* The palettes as after power-on, and the OAM empty. */
+void dino_render_reset(struct dino_render *r);
+
+/* One frame into fb (W*H*3, rows top down).  Uses dino_x/y, ducking,
+   jumping, the obstacle and powerup positions, sprite_state,
+   game_over, godzilla_mode, night_time, cloud_offset and bcd, and the
+   OAM as dino_render_oam() left it. */
+void dino_render_frame(struct dino_render *r, const struct dino_state *s, uint8_t *fb);
+
+#endif
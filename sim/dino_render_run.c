@@ -0,0 +1,514 @@
+/*  dino_render_run.c – drives dino_render
+ *
+ *  Renders frames of a game (the dino standing, replay after every game
+ *  over) and reports frames/s, or writes one frame as a PPM.  --check
+ *  compares it with a clock-by-clock transliteration of vga_ball.sv's
+ *  pixel block over a run of random states.
+ */
+
+#include "dino_render.h"
+#include "dino_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FB_BYTES  (DINO_SCREEN_W * DINO_SCREEN_H * 3)
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int write_ppm(const char *path, const uint8_t *fb)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", DINO_SCREEN_W, DINO_SCREEN_H);
+    fwrite(fb, 1, FB_BYTES, f);
+    return fclose(f);
+}
+
+/* ------------------------------------------------------------------ */
+/*  the RTL, one clock at a time                                       */
+
+/* the object engine's registers: its state, the object being fetched
+   (g_* for the game's, oam_*_q the OAM's) and the row being drawn
+   (d_*); a pixel pair issued and then written; the two line buffers with
+   what their banks read out; the screen side, down to the colour out of
+   the palette RAM and whether it is shown */
+enum { ENG_FETCH, ENG_TEST, ENG_DRAW, ENG_DONE };
+
+struct slow {
+    uint8_t  eng, obj, lb_sel;
+    uint16_t eng_line;
+    uint16_t g_x, g_y;
+    uint8_t  g_id, g_on, g_flip;
+    uint32_t oam_pos_q, oam_attr_q;
+    uint16_t d_x, d_base, d_wrap, d_row;
+    uint16_t d_pal_base, d_pal_mask;
+    uint8_t  d_col, d_w, d_prio, d_flip;
+
+    uint16_t atlas_addr[2], atlas_data[2];
+    uint8_t  mask[2];
+    uint16_t iss_x[2], wr_x[2];
+    uint16_t iss_pal_base, iss_pal_mask, wr_pal_base, wr_pal_mask;
+    uint8_t  iss_ok[2], wr_ok[2], iss_prio, wr_prio;
+
+    uint16_t lb[2][2][1024];            // [buffer][bank], bank = x & 1
+    uint16_t lb_data[2][2];
+
+    uint16_t disp_x, disp_x2;
+    uint8_t  disp_buf, disp_buf2;
+    uint16_t color;
+    uint8_t  on;
+
+    /* the sky's, [0] the cloud and [1] the sun: tile address and hit
+       flag (and the cloud's grey), then the bit out of the ROM, then
+       whether it shows */
+    uint16_t sky_addr[2];
+    uint8_t  sky_hit1[2], sky_hit2[2], sky_bit[2], sky_on[2];
+    uint8_t  grey1, grey2, grey;
+};
+
+static const uint8_t slow_font[10][8] = {
+    {0x3C,0x66,0x6E,0x7E,0x76,0x66,0x3C,0x00}, {0x18,0x38,0x18,0x18,0x18,0x18,0x7E,0x00},
+    {0x3C,0x66,0x06,0x1C,0x30,0x66,0x7E,0x00}, {0x3C,0x66,0x06,0x1C,0x06,0x66,0x3C,0x00},
+    {0x0C,0x1C,0x2C,0x4C,0x7E,0x0C,0x0C,0x00}, {0x7E,0x60,0x7C,0x06,0x06,0x66,0x3C,0x00},
+    {0x3C,0x66,0x60,0x7C,0x66,0x66,0x3C,0x00}, {0x7E,0x06,0x0C,0x18,0x30,0x30,0x30,0x00},
+    {0x3C,0x66,0x66,0x3C,0x66,0x66,0x3C,0x00}, {0x3C,0x66,0x66,0x3E,0x06,0x66,0x3C,0x00},
+};
+
+static void set565(uint8_t *c, uint16_t px)
+{
+    c[0] = (uint8_t)((px >> 11) << 3);
+    c[1] = (uint8_t)(((px >> 5) & 0x3F) << 2);
+    c[2] = (uint8_t)((px & 0x1F) << 3);
+}
+
+/* The sky tiles under (hn, vn): the last cloud whose tile holds it
+   after the scroll (11-bit wrap, as the RTL's sky_u, and its distances
+   from a corner 11 and 10 bits, as cloud_du and cloud_dv), and the
+   sun's quarter tile by |dx|, |dy|. */
+static void sky_lookup(const struct dino_sprites *sp, const struct dino_state *s,
+                       uint32_t hn, uint32_t vn, uint16_t *addr, uint8_t *hit, uint8_t *grey)
+{
+    uint32_t co = s->cloud_offset;
+    uint32_t u = hn >= co ? hn - co : (hn + 1280 - co) & 0x7FF;
+    uint32_t dx = hn >= sp->sun_x ? hn - sp->sun_x : sp->sun_x - hn;
+    uint32_t dy = vn >= sp->sun_y ? vn - sp->sun_y : sp->sun_y - vn;
+
+    hit[0] = 0;
+    for (unsigned k = 0; k < sp->n_clouds; k++) {
+        uint32_t du = (u - sp->cloud_x[k]) & 0x7FF, dv = (vn - sp->cloud_y[k]) & 0x3FF;
+        if (du < 64 && dv < 64) {
+            hit[0] = 1;
+            addr[0] = (uint16_t)((1 + k) * 4096 + dv * 64 + du);
+            *grey = (uint8_t)sp->cloud_grey[k];
+        }
+    }
+    hit[1] = dx < 64 && dy < 64;
+    addr[1] = (uint16_t)(dy % 64 * 64 + dx % 64);
+}
+
+/* vga_ball.sv's game_x/y/id/on/flip: objects 0-6 from the registers. */
+static void game_objects(const struct dino_sprites *sp, const struct dino_state *s,
+                         uint16_t *x, uint16_t *y, uint8_t *id, uint8_t *on, uint8_t *flip)
+{
+    int dino_rom = s->godzilla_mode ? DINO_ROM_GODZILLA
+                 : s->ducking ? DINO_ROM_DUCK
+                 : s->jumping ? DINO_ROM_JUMP
+                 : s->sprite_state == 1 ? DINO_ROM_LEFT
+                 : s->sprite_state == 2 ? DINO_ROM_RIGHT
+                 : DINO_ROM_DINO;
+    int ptr_rom = s->sprite_state == 1 ? DINO_ROM_PTR_UP : DINO_ROM_PTR_DOWN;
+    const int rom[DINO_GAME_OBJECTS] = { DINO_ROM_REPLAY, ptr_rom, DINO_ROM_LAVA, DINO_ROM_GROUP,
+                                         DINO_ROM_S_CAC, dino_rom, DINO_ROM_POWERUP };
+    const uint16_t gx[DINO_GAME_OBJECTS] = { 560, s->ptr_x, s->lava_x, s->group_x,
+                                             s->s_cac_x, s->dino_x, s->powerup_x };
+    const uint16_t gy[DINO_GAME_OBJECTS] = { 200, s->ptr_y, s->lava_y, s->group_y,
+                                             s->s_cac_y, s->dino_y, s->powerup_y };
+
+    for (int i = 0; i < DINO_GAME_OBJECTS; i++) {
+        x[i] = gx[i] & 0x7FF;
+        y[i] = gy[i] & 0x7FF;
+        id[i] = (uint8_t)sp->pal[rom[i]];
+        on[i] = i == 0 ? s->game_over : !s->game_over;
+        flip[i] = i == 1;
+    }
+}
+
+/* One frame, starting a line and four clocks early (where the engine
+   starts on the frame's first line) from empty buffers and the engine
+   idle. */
+static void slow_frame(struct slow *sl, const struct dino_sprites *sp, const uint16_t *palette,
+                       const uint32_t *oam, const struct dino_state *s, uint8_t *fb)
+{
+    const uint32_t total = DINO_SCREEN_HTOTAL * DINO_SCREEN_VTOTAL;
+    const uint32_t lead = DINO_SCREEN_HTOTAL + 4;
+    uint16_t gx[DINO_GAME_OBJECTS], gy[DINO_GAME_OBJECTS];
+    uint8_t gid[DINO_GAME_OBJECTS], gon[DINO_GAME_OBJECTS], gflip[DINO_GAME_OBJECTS];
+
+    memset(sl, 0, sizeof *sl);
+    sl->eng = ENG_DONE;
+    game_objects(sp, s, gx, gy, gid, gon, gflip);
+
+    for (uint32_t clk = 0; clk < total + lead; clk++) {
+        uint32_t t = (clk + total - lead) % total;
+        uint32_t h = t % DINO_SCREEN_HTOTAL, v = t / DINO_SCREEN_HTOTAL;
+        uint8_t c[3] = { 135, 206, 235 };
+        uint16_t px = sl->color;
+        int on = sl->on;
+
+        if (!s->game_over) {
+            if (v < 280) {
+                c[0] = s->night_time ? 10 : 135;
+                c[1] = s->night_time ? 10 : 206;
+                c[2] = s->night_time ? 40 : 235;
+            } else if (v > 300) {
+                c[0] = 100; c[1] = 40; c[2] = 10;
+            } else {
+                c[0] = 139; c[1] = 69; c[2] = 19;
+            }
+            if (v == 280)
+                c[0] = c[1] = c[2] = 0;
+            if (sl->sky_on[1]) {
+                c[0] = 255; c[1] = 255; c[2] = s->night_time ? 255 : 0;
+            }
+            if (sl->sky_on[0])
+                c[0] = c[1] = c[2] = sl->grey;
+            if (((h > 300 && h < 305) && v == 50) || ((h > 305 && h < 310) && v == 51) ||
+                ((h > 310 && h < 315) && v == 50) || ((h > 600 && h < 605) && v == 80) ||
+                ((h > 605 && h < 610) && v == 81) || ((h > 610 && h < 615) && v == 80))
+                c[0] = c[1] = c[2] = 0;
+            if (v > 280 && v < 480 &&
+                ((h % 120 == 0 && v % 50 < 10) || (h % 200 == 15 && v % 60 < 8))) {
+                c[0] = 110; c[1] = 50; c[2] = 10;
+            }
+            if (on)
+                set565(c, px);
+            if (v >= 10 && v < 18 && h >= 120 && h < 160) {
+                uint32_t rx = h - 120, idx = rx / 8, cx = rx % 8, ry = v - 10;
+                unsigned digit = s->bcd[DINO_N_DIGITS - 1 - idx];
+                if (digit <= 9 && (slow_font[digit][ry] >> (7 - cx)) & 1)
+                    c[0] = c[1] = c[2] = 0;
+            }
+        } else if (on) {
+            set565(c, px);
+        }
+
+        if (clk >= lead && h < DINO_SCREEN_W && v < DINO_SCREEN_H)
+            memcpy(fb + 3 * (v * DINO_SCREEN_W + h), c, 3);
+
+        /* the lookahead: the pixel three clocks on */
+        uint32_t hn = h >= DINO_SCREEN_HTOTAL - 3 ? h - (DINO_SCREEN_HTOTAL - 3) : h + 3;
+        uint32_t vn = h < DINO_SCREEN_HTOTAL - 3 ? v : v == DINO_SCREEN_VTOTAL - 1 ? 0 : v + 1;
+
+        for (int i = 0; i < 2; i++) {
+            sl->sky_on[i] = sl->sky_hit2[i] && sl->sky_bit[i];
+            sl->sky_bit[i] = (uint8_t)(sp->sky[sl->sky_addr[i] / 32] >> (sl->sky_addr[i] % 32) & 1);
+            sl->sky_hit2[i] = sl->sky_hit1[i];
+        }
+        sl->grey = sl->grey2;
+        sl->grey2 = sl->grey1;
+        sky_lookup(sp, s, hn, vn, sl->sky_addr, sl->sky_hit1, &sl->grey1);
+
+        /* the object under test */
+        uint32_t tx, ty, tid, tpal, ton, tflip, tprio;
+        if (sl->obj < DINO_GAME_OBJECTS) {
+            tx = sl->g_x; ty = sl->g_y; tid = tpal = sl->g_id;
+            ton = sl->g_on; tflip = sl->g_flip; tprio = DINO_GAME_PRIORITY;
+        } else {
+            tx = sl->oam_pos_q & 0x7FF; ty = sl->oam_pos_q >> 16 & 0x3FF;
+            tid = sl->oam_attr_q & 15; tpal = sl->oam_attr_q >> 4 & 15;
+            ton = sl->oam_attr_q >> 15 & 1; tflip = sl->oam_attr_q >> 8 & 1;
+            tprio = sl->oam_attr_q >> 9 & 7;
+        }
+        int thit = ton && tid < sp->n_ids && sl->eng_line >= ty && sl->eng_line < ty + 32;
+        unsigned tw = tid < sp->n_ids ? sp->id_width[tid] : 0;
+
+        /* the pair at d_col */
+        uint8_t col[2] = { sl->d_flip ? (uint8_t)(sl->d_w - 1 - sl->d_col) : sl->d_col,
+                           sl->d_flip ? (uint8_t)(sl->d_w - 2 - sl->d_col)
+                                      : (uint8_t)(sl->d_col + 1) };
+        uint32_t x[2] = { (sl->d_x + sl->d_col) & 0xFFF, (sl->d_x + sl->d_col + 1) & 0xFFF };
+
+        /* the line buffers: the screen's read and clear, the pair's
+           read, and its write over empty or further back */
+        uint16_t lb_address[2][2], lb_write_address[2][2], lb_writedata[2][2];
+        uint8_t lb_write[2][2], put[2];
+        for (int j = 0; j < 2; j++) {
+            uint16_t old = sl->lb_data[!sl->lb_sel][sl->wr_x[j] & 1];
+            put[j] = sl->wr_ok[j] && sl->mask[j] &&
+                     (!(old >> 14 & 1) || sl->wr_prio < (old >> 11 & 7));
+        }
+        uint16_t disp_px = sl->lb_data[sl->disp_buf2][sl->disp_x2 & 1];
+        for (int i = 0; i < 2; i++)
+            for (int k = 0; k < 2; k++) {
+                int j = (sl->iss_x[0] & 1) == k ? 0 : 1;
+                lb_address[i][k] = i == sl->disp_buf ? sl->disp_x >> 1 : sl->iss_x[j] >> 1;
+                j = (sl->wr_x[0] & 1) == k ? 0 : 1;
+                if (i == sl->disp_buf2 && (sl->disp_x2 & 1) == k) {
+                    lb_write[i][k] = 1;
+                    lb_write_address[i][k] = sl->disp_x2 >> 1;
+                    lb_writedata[i][k] = 0;
+                } else {
+                    lb_write[i][k] = put[j] && i != sl->lb_sel;
+                    lb_write_address[i][k] = sl->wr_x[j] >> 1;
+                    lb_writedata[i][k] = (uint16_t)(1 << 14 | sl->wr_prio << 11 | sl->wr_pal_base |
+                                                    (sl->atlas_data[j] & sl->wr_pal_mask));
+                }
+            }
+
+        /* the clock edge: RAM reads see the old contents */
+        for (int i = 0; i < 2; i++)
+            for (int k = 0; k < 2; k++)
+                sl->lb_data[i][k] = sl->lb[i][k][lb_address[i][k] & 1023];
+        for (int i = 0; i < 2; i++)
+            for (int k = 0; k < 2; k++)
+                if (lb_write[i][k])
+                    sl->lb[i][k][lb_write_address[i][k] & 1023] = lb_writedata[i][k];
+
+        sl->color = palette[disp_px & 0x7FF];
+        sl->on = disp_px >> 14 & 1;
+        sl->disp_x2 = sl->disp_x;
+        sl->disp_buf2 = sl->disp_buf;
+        sl->disp_x = (uint16_t)hn;
+        sl->disp_buf = sl->lb_sel;
+
+        for (int j = 0; j < 2; j++) {
+            sl->atlas_data[j] = sp->atlas[sl->atlas_addr[j]];
+            sl->mask[j] = (uint8_t)dino_sprite_opaque(sp, sl->atlas_addr[j]);
+            sl->wr_x[j] = sl->iss_x[j];
+            sl->wr_ok[j] = sl->iss_ok[j];
+            sl->atlas_addr[j] = (uint16_t)(sl->d_base + ((sl->d_row + col[j]) & sl->d_wrap));
+            sl->iss_x[j] = (uint16_t)(x[j] & 0x7FF);
+            sl->iss_ok[j] = sl->eng == ENG_DRAW && hn < DINO_SCREEN_HTOTAL - 2 &&
+                            x[j] < DINO_SCREEN_W;
+        }
+        sl->wr_pal_base = sl->iss_pal_base;
+        sl->wr_pal_mask = sl->iss_pal_mask;
+        sl->wr_prio = sl->iss_prio;
+        sl->iss_pal_base = sl->d_pal_base;
+        sl->iss_pal_mask = sl->d_pal_mask;
+        sl->iss_prio = sl->d_prio;
+
+        unsigned entry = (sl->obj - DINO_GAME_OBJECTS) & (DINO_OAM_ENTRIES - 1);
+        sl->oam_pos_q = oam[2 * entry];
+        sl->oam_attr_q = oam[2 * entry + 1];
+
+        if (hn == DINO_SCREEN_HTOTAL - 1) {
+            sl->lb_sel = !sl->lb_sel;
+            sl->eng = ENG_FETCH;
+            sl->obj = 0;
+            sl->eng_line = (uint16_t)(vn >= DINO_SCREEN_VTOTAL - 2 ? vn - (DINO_SCREEN_VTOTAL - 2)
+                                                                   : vn + 2);
+        } else if (sl->eng == ENG_FETCH) {
+            unsigned g = sl->obj & 7;       // obj[2:0]; past 6 it is unused
+            if (g < DINO_GAME_OBJECTS) {
+                sl->g_x = gx[g]; sl->g_y = gy[g]; sl->g_id = gid[g];
+                sl->g_on = gon[g]; sl->g_flip = gflip[g];
+            }
+            sl->eng = ENG_TEST;
+        } else if (sl->eng == ENG_TEST) {
+            sl->d_x = (uint16_t)tx;
+            sl->d_col = 0;
+            sl->d_w = (uint8_t)tw;
+            sl->d_base = (uint16_t)(tid < sp->n_ids ? sp->id_base[tid] : 0);
+            sl->d_wrap = (uint16_t)(tid < sp->n_ids ? sp->id_wrap[tid] : 0);
+            sl->d_row = (uint16_t)((sl->eng_line - ty) * tw & 0x3FFF);
+            sl->d_pal_base = (uint16_t)sp->pal_base[tpal];
+            sl->d_pal_mask = (uint16_t)sp->pal_mask[tpal];
+            sl->d_prio = (uint8_t)tprio;
+            sl->d_flip = (uint8_t)tflip;
+            if (thit) {
+                sl->eng = ENG_DRAW;
+            } else if (sl->obj == DINO_OBJECTS - 1) {
+                sl->eng = ENG_DONE;
+            } else {
+                sl->obj++;
+                sl->eng = ENG_FETCH;
+            }
+        } else if (sl->eng == ENG_DRAW) {
+            sl->d_col = (uint8_t)(sl->d_col + 2);
+            if (sl->d_col >= sl->d_w && sl->obj == DINO_OBJECTS - 1) {
+                sl->eng = ENG_DONE;
+            } else if (sl->d_col >= sl->d_w) {
+                sl->obj++;
+                sl->eng = ENG_FETCH;
+            }
+        }
+    }
+}
+
+/* ------------------------------------------------------------------ */
+
+static uint32_t rng_next(uint32_t *r)
+{
+    *r ^= *r << 13; *r ^= *r >> 17; *r ^= *r << 5;
+    return *r;
+}
+
+/* Somewhere interesting for a sprite: often near an edge. */
+static uint16_t pick(uint32_t *rng, const uint16_t *edges, int n, unsigned span)
+{
+    uint32_t r = rng_next(rng);
+    if (r & 1)
+        return (uint16_t)((r >> 8) % span);
+    return (uint16_t)(edges[(r >> 8) % n] + (int)((r >> 20) % 9) - 4);
+}
+
+static int check(const struct dino_sprites *sp, struct dino_render *r, unsigned frames)
+{
+    static const uint16_t xe[] = { 4, 1248, 1280, 1600, 1560, 2000 };
+    static const uint16_t ye[] = { 4, 200, 248, 460, 480, 520 };
+    static uint8_t fast_fb[FB_BYTES], slow_fb[FB_BYTES];
+    uint16_t palette[DINO_PALETTE_WORDS];
+    uint32_t oam[2 * DINO_OAM_ENTRIES];
+    static struct slow sl;
+    struct dino_state s;
+    uint32_t rng = 2463534242u;
+
+    memcpy(palette, sp->palette, sizeof palette);
+    memset(oam, 0, sizeof oam);
+    dino_render_reset(r);
+    dino_sim_init(&s);
+
+    for (unsigned f = 0; f < frames; f++) {
+        uint32_t b = rng_next(&rng);
+        s.game_over     = (b & 7) == 0;
+        s.godzilla_mode = (b >> 3 & 7) == 0;
+        s.ducking       = (b >> 6 & 3) == 0;
+        s.jumping       = (b >> 8 & 3) == 0;
+        s.sprite_state  = b >> 10 & 3;
+        s.night_time    = b >> 12 & 1;
+        s.cloud_offset  = (uint16_t)(rng_next(&rng) % 1282);
+        s.dino_x    = pick(&rng, xe, 6, 1024);
+        s.dino_y    = pick(&rng, ye, 6, 1024);
+        s.s_cac_x   = pick(&rng, xe, 6, 2048);
+        s.group_x   = pick(&rng, xe, 6, 2048);
+        s.lava_x    = pick(&rng, xe, 6, 2048);
+        s.lava_y    = pick(&rng, ye, 6, 1024);
+        s.ptr_x     = pick(&rng, xe, 6, 2048);
+        s.powerup_x = pick(&rng, xe, 6, 2048);
+        for (int i = 0; i < DINO_N_DIGITS; i++)
+            s.bcd[i] = (uint8_t)(rng_next(&rng) % 11);
+        for (int i = rng_next(&rng) % 4; i > 0; i--) {
+            /* palette writes, now and then the old colour key (which is
+               just magenta now) */
+            uint32_t w = rng_next(&rng);
+            uint16_t px = (w >> 8 & 7) == 0 ? 0xF81F : (uint16_t)(w >> 16);
+            unsigned entry = (w & 0xFF) | (w >> 13 & 7) << 8;
+            palette[entry] = px;
+            dino_render_palette(r, entry, px);
+        }
+        for (int i = (b >> 13 & 7) == 0 ? 128 : rng_next(&rng) % 24; i > 0; i--) {
+            /* OAM writes: ids past the atlas, flips, priorities, entries
+               turned off, junk in the unused bits, and now and then the
+               whole table on a few lines, past the engine's budget */
+            uint32_t w = rng_next(&rng);
+            unsigned e = (w >> 26) % DINO_OAM_ENTRIES;
+            uint32_t pos = DINO_OAM_POS(pick(&rng, xe, 6, 2048),
+                                        (w & 3) == 0 || i > 24 ? 240 + (w >> 2) % 8
+                                                               : pick(&rng, ye, 6, 1024));
+            unsigned id = i > 24 && (w >> 8 & 1) ? sp->pal[DINO_ROM_REPLAY] : w >> 8 & 15;
+            uint32_t attr = DINO_OAM_ATTR(id, w >> 12 & 15, w >> 16 & 1, w >> 17 & 7);
+            if ((w >> 20 & 7) == 0)
+                attr &= ~0x8000u;
+            attr |= (w >> 23 & 7) << 12 | (w & 0xF000) << 16;
+            for (unsigned k = 0; k < 2; k++) {
+                uint32_t value = k ? attr : pos | (w & 0xF800) | (w & 0xFC) << 24;
+                oam[2 * e + k] = value & (k ? 0xFFFF : 0x3FFFFFF);
+                dino_render_oam(r, 2 * e + k, value);
+            }
+        }
+
+        dino_render_frame(r, &s, fast_fb);
+        slow_frame(&sl, sp, palette, oam, &s, slow_fb);
+        if (memcmp(fast_fb, slow_fb, FB_BYTES) != 0) {
+            for (int i = 0; i < FB_BYTES; i += 3)
+                if (memcmp(fast_fb + i, slow_fb + i, 3)) {
+                    int p = i / 3;
+                    printf("frame %u differs at (%d,%d): %u,%u,%u vs rtl %u,%u,%u\n", f,
+                           p % DINO_SCREEN_W, p / DINO_SCREEN_W, fast_fb[i], fast_fb[i + 1],
+                           fast_fb[i + 2], slow_fb[i], slow_fb[i + 1], slow_fb[i + 2]);
+                    break;
+                }
+            write_ppm("check_fast.ppm", fast_fb);
+            write_ppm("check_rtl.ppm", slow_fb);
+            return 1;
+        }
+    }
+    printf("check: %u frames identical\n", frames);
+    return 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-f FRAMES] [-t TICKS] [-o OUT.ppm] [--hex DIR] [--check FRAMES]\n",
+            argv0);
+}
+
+int main(int argc, char **argv)
+{
+    static struct dino_sprites sp;
+    static struct dino_render r;
+    static uint8_t fb[FB_BYTES];
+    unsigned frames = 5000, check_frames = 0;
+    uint64_t ticks = 0;
+    const char *hex_dir = "hex", *out = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc)
+            frames = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            ticks = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            out = argv[++i];
+        else if (!strcmp(argv[i], "--hex") && i + 1 < argc)
+            hex_dir = argv[++i];
+        else if (!strcmp(argv[i], "--check") && i + 1 < argc)
+            check_frames = strtoul(argv[++i], NULL, 0);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (dino_sprites_load(&sp, hex_dir) < 0 || dino_render_init(&r, &sp) < 0)
+        return 1;
+    if (check_frames)
+        return check(&sp, &r, check_frames);
+
+    struct dino_state s;
+    dino_sim_init(&s);
+    dino_sim_ticks(&s, ticks);
+
+    if (out) {
+        dino_render_frame(&r, &s, fb);
+        return write_ppm(out, fb) < 0;
+    }
+
+    /* a frame is 840000 clocks; step the game that much between frames */
+    double busy = 0;
+    for (unsigned f = 0; f < frames; f++) {
+        if (s.game_over) {
+            dino_sim_write(&s, DINO_REG_REPLAY, 1);
+            dino_sim_run(&s, 1);
+            dino_sim_write(&s, DINO_REG_REPLAY, 0);
+        }
+        dino_sim_run(&s, DINO_SCREEN_HTOTAL * DINO_SCREEN_VTOTAL);
+        double t0 = now_s();
+        dino_render_frame(&r, &s, fb);
+        busy += now_s() - t0;
+    }
+    printf("%u frames in %.3f s: %.0f frames/s (%.1f us/frame)\n",
+           frames, busy, frames / busy, busy / frames * 1e6);
+    return 0;
+}
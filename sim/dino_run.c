@@ -0,0 +1,271 @@
+/*  dino_run.c – command-line driver for the vga_ball game model
+ *
+ *  Runs the model headless with the dino standing still (or a scripted
+ *  replay press after every game over; without one it stops at the
+ *  first) and reports how fast it goes.
+ *  --check compares the fast path against plain cycle-by-cycle stepping,
+ *  --validate compares event skipping (--skip) against tick-by-tick,
+ *  --rewind plays a random jumper that rolls back from every crash.
+ */
+
+#include "dino_sim.h"
+#include "dino_play.h"
+#include "dino_snap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_state(FILE *f, const char *tag, const struct dino_state *s)
+{
+    fprintf(f, "%s cyc=%llu mt=%u lfsr=%02x spd=%u pc=%u s_cac=%u group=%u lava=%u ptr=%u "
+               "pwr=%u score=%u bcd=%u%u%u%u%u go=%u gz=%u gt=%llu ss=%u night=%u cloud=%u\n",
+            tag, (unsigned long long)s->cycles, s->motion_timer, s->lfsr,
+            s->obstacle_speed, s->passed_count, s->s_cac_x, s->group_x,
+            s->lava_x, s->ptr_x, s->powerup_x, s->score,
+            s->bcd[4], s->bcd[3], s->bcd[2], s->bcd[1], s->bcd[0],
+            s->game_over, s->godzilla_mode,
+            (unsigned long long)s->godzilla_timer, s->sprite_state,
+            s->night_time, s->cloud_offset);
+}
+
+/* Presses replay for one tick after a game over, like the pad would. */
+static void replay(struct dino_state *s, void (*tick)(struct dino_state *))
+{
+    dino_sim_write(s, DINO_REG_REPLAY, 1);
+    tick(s);
+    dino_sim_write(s, DINO_REG_REPLAY, 0);
+}
+
+static void slow_tick(struct dino_state *s)
+{
+    for (uint32_t i = 0; i < DINO_MOTION_PERIOD; i++)
+        dino_sim_cycle(s);
+}
+
+static int check(uint64_t ticks, int dino_x, int dino_y)
+{
+    struct dino_state fast, slow;
+
+    dino_sim_init(&fast);
+    dino_sim_init(&slow);
+    dino_sim_write(&fast, DINO_REG_DINO_X, dino_x);
+    dino_sim_write(&slow, DINO_REG_DINO_X, dino_x);
+    dino_sim_write(&fast, DINO_REG_DINO_Y, dino_y);
+    dino_sim_write(&slow, DINO_REG_DINO_Y, dino_y);
+
+    for (uint64_t t = 0; t < ticks; t++) {
+        if (fast.game_over) replay(&fast, dino_sim_tick);
+        else dino_sim_tick(&fast);
+        if (slow.game_over) replay(&slow, slow_tick);
+        else slow_tick(&slow);
+
+        if (memcmp(&fast, &slow, sizeof fast) != 0) {
+            printf("mismatch after tick %llu\n", (unsigned long long)t);
+            print_state(stdout, "fast", &fast);
+            print_state(stdout, "slow", &slow);
+            return 1;
+        }
+    }
+    printf("check: %llu ticks identical\n", (unsigned long long)ticks);
+    return 0;
+}
+
+/* Event skipping against dino_sim_tick(), compared at random points. */
+static int validate(uint64_t ticks, int dino_x, int dino_y)
+{
+    struct dino_state skip, step;
+    uint64_t rng = 88172645463325252ull, skipped = 0;
+
+    dino_sim_init(&skip);
+    dino_sim_init(&step);
+    dino_sim_write(&skip, DINO_REG_DINO_X, dino_x);
+    dino_sim_write(&step, DINO_REG_DINO_X, dino_x);
+    dino_sim_write(&skip, DINO_REG_DINO_Y, dino_y);
+    dino_sim_write(&step, DINO_REG_DINO_Y, dino_y);
+
+    for (uint64_t t = 0; t < ticks; ) {
+        uint64_t n;
+
+        if (skip.game_over) {
+            replay(&skip, dino_sim_tick);
+            replay(&step, dino_sim_tick);
+            n = 1;
+        } else {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+            uint64_t chunk = 1 + rng % 5000;
+            if (chunk > ticks - t)
+                chunk = ticks - t;
+            n = dino_sim_ticks(&skip, chunk);
+            for (uint64_t i = 0; i < n; i++)
+                dino_sim_tick(&step);
+            skipped += n;
+        }
+        t += n;
+
+        if (memcmp(&skip, &step, sizeof skip) != 0) {
+            printf("mismatch after tick %llu\n", (unsigned long long)t);
+            print_state(stdout, "skip", &skip);
+            print_state(stdout, "step", &step);
+            return 1;
+        }
+    }
+    printf("validate: %llu ticks identical\n", (unsigned long long)skipped);
+    return 0;
+}
+
+/* Snapshot every tick; on a crash go back `depth` ticks and try other
+   inputs.  Then time save/restore on their own. */
+static int rewind_play(uint64_t ticks, uint32_t depth)
+{
+    struct dino_snap_ring ring;
+    struct dino_state s;
+    struct dino d = { .x = 100, .y_fixed = GROUND_Y_FIXED };
+    uint32_t rng = 2463534242u;
+    uint64_t rollbacks = 0, replays = 0, best = 0;
+
+    if (dino_snap_ring_init(&ring, 1024)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    if (depth > 1023)
+        depth = 1023;
+    dino_sim_init(&s);
+
+    for (uint64_t t = 0; t < ticks; t++) {
+        dino_snap_push(&ring, &s, &d, t);
+
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        dino_play_tick(&s, &d, rng % 40 == 0);
+
+        if (s.score > best)
+            best = s.score;
+        if (!s.game_over)
+            continue;
+        if (ring.count > depth && !dino_snap_rollback(&ring, depth, &s, &d)) {
+            rollbacks++;
+        } else {
+            dino_play_replay(&s, &d);
+            replays++;
+        }
+    }
+    printf("rewind: %llu ticks, %llu rollbacks, %llu replays, best score %llu\n",
+           (unsigned long long)ticks, (unsigned long long)rollbacks,
+           (unsigned long long)replays, (unsigned long long)best);
+
+    enum { N = 10000000 };
+    struct dino_state s2;
+    struct dino d2;
+    double t0 = now_s();
+    for (uint32_t i = 0; i < N; i++) {
+        s.cycles = i;                           /* keep the copies honest */
+        dino_snap_push(&ring, &s, &d, i);
+    }
+    double t1 = now_s();
+    for (uint32_t i = 0; i < N; i++) {
+        dino_snap_restore(dino_snap_back(&ring, i & 511), &s2, &d2);
+        __asm__ volatile("" : : "r"(&s2), "r"(&d2) : "memory");
+    }
+    double t2 = now_s();
+    printf("snapshot %zu bytes: save %.1f ns, restore %.1f ns\n",
+           sizeof(struct dino_snapshot), (t1 - t0) / N * 1e9, (t2 - t1) / N * 1e9);
+
+    dino_snap_ring_free(&ring);
+    return 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-t TICKS] [-x DINO_X] [-y DINO_Y] [--replay] [--skip] [--trace]\n"
+            "       [--check TICKS] [--validate TICKS] [--rewind DEPTH]\n",
+            argv0);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t ticks = 10000000, check_ticks = 0, validate_ticks = 0;
+    uint32_t rewind_depth = 0;
+    int dino_x = 100, dino_y = 248, auto_replay = 0, skip = 0, trace = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            ticks = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc)
+            dino_x = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-y") && i + 1 < argc)
+            dino_y = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--replay"))
+            auto_replay = 1;
+        else if (!strcmp(argv[i], "--skip"))
+            skip = 1;
+        else if (!strcmp(argv[i], "--trace"))
+            trace = 1;
+        else if (!strcmp(argv[i], "--check") && i + 1 < argc)
+            check_ticks = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--validate") && i + 1 < argc)
+            validate_ticks = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--rewind") && i + 1 < argc)
+            rewind_depth = strtoul(argv[++i], NULL, 0);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (check_ticks)
+        return check(check_ticks, dino_x, dino_y);
+    if (validate_ticks)
+        return validate(validate_ticks, dino_x, dino_y);
+    if (rewind_depth)
+        return rewind_play(ticks, rewind_depth);
+
+    struct dino_state s;
+    uint64_t games = 0, best = 0;
+
+    dino_sim_init(&s);
+    dino_sim_write(&s, DINO_REG_DINO_X, dino_x);
+    dino_sim_write(&s, DINO_REG_DINO_Y, dino_y);
+
+    // Without --replay the game freezes at its first game over; ticks
+    // after that would only time the frozen screen, so stop there.
+    double t0 = now_s();
+    uint64_t t = 0;
+    while (t < ticks) {
+        if (s.game_over && !auto_replay)
+            break;
+        if (s.game_over) {
+            games++;
+            if (s.score > best) best = s.score;
+            replay(&s, dino_sim_tick);
+            t++;
+        } else if (skip) {
+            t += dino_sim_ticks(&s, trace ? 1 : ticks - t);
+        } else {
+            dino_sim_tick(&s);
+            t++;
+        }
+        if (trace)
+            print_state(stdout, "tick", &s);
+    }
+    double dt = now_s() - t0;
+
+    print_state(stdout, "final", &s);
+    if (t < ticks)
+        printf("game over at tick %llu, no --replay: stopped there\n",
+               (unsigned long long)t);
+    printf("%llu ticks in %.3f s: %.2f M ticks/s (%.0fx real time)\n",
+           (unsigned long long)t, dt, t / dt / 1e6,
+           t * (double)DINO_MOTION_PERIOD / 50e6 / dt);
+    if (auto_replay)
+        printf("%llu games, best score %llu\n",
+               (unsigned long long)games, (unsigned long long)best);
+    return 0;
+}
@@ -0,0 +1,477 @@
+/*  dino_sim.c – cycle-exact model of the vga_ball.sv game logic
+ *
+ *  cycle() is a literal transcription of one posedge of the big
+ *  always_ff block (plus the separate lfsr block): every right-hand side
+ *  reads the old state and later non-blocking assignments win.
+ *
+ *  Between motion updates nothing but free-running counters changes as
+ *  long as no collide() is true, so dino_sim_run() executes single
+ *  cycles only around events and jumps the counters in one step
+ *  otherwise.  That is what makes a motion tick cost ~tens of ns.
+ *
+ *  dino_sim_skip() goes one step further and applies whole runs of
+ *  event-free motion updates in closed form.
+ */
+
+#include "dino_sim.h"
+#include <string.h>
+
+#define X11(v)  ((uint16_t)((v) & 0x7FF))
+
+void dino_sim_init(struct dino_state *s)
+{
+    memset(s, 0, sizeof *s);
+
+    /* declaration initialisers */
+    s->dino_x  = 100;  s->dino_y  = 248;
+    s->s_cac_y = 248;
+    s->group_y = 248;
+    s->lava_y  = 248;
+    s->ptr_y   = 200;
+
+    /* reset branch */
+    s->lfsr           = 0x2B;       // 6'b101011
+    s->s_cac_x        = 1200;
+    s->group_x        = 1600;
+    s->lava_x         = 1800;
+    s->ptr_x          = 1400;
+    s->obstacle_speed = 1;
+    s->powerup_x      = 800;
+    s->powerup_y      = 248;
+}
+
+/* ------------------------------------------------------------------ */
+/*  combinational helpers                                              */
+
+static inline int hit_s_cac(const struct dino_state *s)
+{
+    return dino_collide(s->dino_x, s->dino_y, s->s_cac_x, s->s_cac_y, 32, 32, 32, 32);
+}
+
+static inline int hit_group(const struct dino_state *s)
+{
+    return dino_collide(s->dino_x, s->dino_y, s->group_x, s->group_y, 64, 32, 32, 32);
+}
+
+static inline int hit_lava(const struct dino_state *s)
+{
+    return dino_collide(s->dino_x, s->dino_y, s->lava_x, s->lava_y, 32, 32, 32, 32);
+}
+
+static inline int hit_ptr(const struct dino_state *s)
+{
+    return dino_collide(s->dino_x, s->dino_y, s->ptr_x, s->ptr_y, 32, 32, 32, 32);
+}
+
+static inline int hit_powerup(const struct dino_state *s)
+{
+    return dino_collide(s->dino_x, s->dino_y, s->powerup_x, s->powerup_y, 32, 32, 32, 32);
+}
+
+/* Nothing can change except counters while this holds. */
+static inline int quiet(const struct dino_state *s)
+{
+    return !(hit_s_cac(s) | hit_group(s) | hit_lava(s) | hit_ptr(s) | hit_powerup(s));
+}
+
+static inline uint8_t lfsr_next(uint8_t l)
+{
+    return (uint8_t)(((l << 1) & 0x3E) | (((l >> 5) ^ (l >> 4)) & 1));
+}
+
+/* Counter that counts 0..limit and clears on the cycle after limit.
+   Advances k cycles, returns how many times it cleared. */
+static inline uint64_t wrap_counter_32(uint32_t *c, uint32_t limit, uint64_t k)
+{
+    uint64_t pos = *c + k;
+    if (pos <= limit) {
+        *c = (uint32_t)pos;
+        return 0;
+    }
+    uint64_t period = (uint64_t)limit + 1;
+    *c = (uint32_t)(pos % period);
+    return pos / period;
+}
+
+static inline uint64_t wrap_counter_64(uint64_t *c, uint64_t limit, uint64_t k)
+{
+    uint64_t pos = *c + k;
+    if (pos <= limit) {
+        *c = pos;
+        return 0;
+    }
+    uint64_t period = limit + 1;
+    *c = pos % period;
+    return pos / period;
+}
+
+/* ------------------------------------------------------------------ */
+/*  one clock, no bus write                                            */
+
+static void cycle(struct dino_state *s)
+{
+    const struct dino_state o = *s;            /* right-hand sides */
+
+    s->cycles++;
+
+    if (o.game_over) {
+        if (o.replay_button) {
+            s->s_cac_x        = 1200;
+            s->group_x        = 1600;
+            s->lava_x         = 1800;
+            s->ptr_x          = 1400;
+            s->obstacle_speed = 1;
+            s->passed_count   = 0;
+            s->game_over      = 0;
+            s->score          = 0;
+            s->motion_timer   = 0;
+            s->godzilla_mode  = 0;
+            s->godzilla_timer = 0;
+            s->powerup_x      = 800;
+            s->powerup_y      = 248;
+            memset(s->bcd, 0, sizeof s->bcd);
+            s->score_ticks    = 0;
+        }
+        return;
+    }
+
+    if (o.motion_timer >= DINO_MOTION_LIMIT) {
+        uint16_t sp = o.obstacle_speed;
+
+        s->lfsr = lfsr_next(o.lfsr);
+
+        s->s_cac_x   = o.s_cac_x <= sp ? X11(DINO_HACTIVE + (o.lfsr << 4))
+                                       : X11(o.s_cac_x - sp);
+        s->group_x   = o.group_x <= sp ? X11(DINO_HACTIVE + ((o.lfsr ^ 0x3F) << 4))
+                                       : X11(o.group_x - sp);
+        s->lava_x    = o.lava_x  <= sp ? X11(DINO_HACTIVE + ((o.lfsr & 0xF) << 6))
+                                       : X11(o.lava_x - sp);
+        s->ptr_x     = o.ptr_x   <= sp ? X11(DINO_HACTIVE + ((o.lfsr >> 2) << 6))
+                                       : X11(o.ptr_x - sp);
+        s->powerup_x = o.powerup_x <= sp ? X11(DINO_HACTIVE + ((o.lfsr & 0x1F) << 5))
+                                         : X11(o.powerup_x - sp);
+
+        /* bcd: the carry is taken from a digit that already reads 10 */
+        s->bcd[0] = (o.bcd[0] + 1) & 0xF;
+        for (int i = 0; i < DINO_N_DIGITS - 1; i++) {
+            if (o.bcd[i] == 10) {
+                s->bcd[i]   = 0;
+                s->bcd[i+1] = (o.bcd[i+1] + 1) & 0xF;
+            }
+        }
+        if (o.bcd[DINO_N_DIGITS-1] == 10)
+            s->bcd[DINO_N_DIGITS-1] = 0;
+
+        s->score = o.score == 99999 ? 0 : (o.score + 1) & 0x1FFFF;
+        s->score_ticks = o.score_ticks + 1;
+
+        if (o.s_cac_x <= sp || o.group_x <= sp || o.lava_x <= sp || o.ptr_x <= sp)
+            s->passed_count = (o.passed_count + 1) & 0x1F;
+        if (o.passed_count >= 12) {
+            s->obstacle_speed = X11(sp + 1);
+            s->passed_count   = 0;
+        }
+
+        s->motion_timer = 0;
+        s->sprite_state = (o.sprite_state + 1) & 3;
+    } else {
+        s->motion_timer = o.motion_timer + 1;
+    }
+
+    if (!o.godzilla_mode &&
+        (hit_s_cac(&o) || hit_group(&o) || hit_lava(&o) || hit_ptr(&o)))
+        s->game_over = 1;
+
+    if (o.frame_counter == DINO_FRAME_LIMIT) {
+        s->sprite_state  = (o.sprite_state + 1) & 3;
+        s->frame_counter = 0;
+    } else {
+        s->frame_counter = o.frame_counter + 1;
+    }
+
+    if (o.cloud_counter == DINO_CLOUD_LIMIT) {
+        s->cloud_counter = 0;
+        s->cloud_offset  = o.cloud_offset > 1280 ? 0 : X11(o.cloud_offset + 1);
+    } else {
+        s->cloud_counter = o.cloud_counter + 1;
+    }
+
+    if (o.night_timer < DINO_NIGHT_LIMIT) {
+        s->night_timer = o.night_timer + 1;
+    } else if (o.night_timer == DINO_NIGHT_LIMIT) {
+        s->night_time  = !o.night_time;
+        s->night_timer = 0;
+    }
+
+    if (hit_powerup(&o)) {
+        s->godzilla_mode  = 1;
+        s->godzilla_timer = 0;
+        s->powerup_x      = DINO_SMASHED_X;
+    }
+
+    if (o.godzilla_mode) {
+        if (hit_s_cac(&o)) s->s_cac_x = DINO_SMASHED_X;
+        if (hit_group(&o)) s->group_x = DINO_SMASHED_X;
+        if (hit_lava(&o))  s->lava_x  = DINO_SMASHED_X;
+        if (hit_ptr(&o))   s->ptr_x   = DINO_SMASHED_X;
+        s->godzilla_timer = (o.godzilla_timer + 1) & 0xFFFFFFFFFFull;
+    }
+
+    if (o.godzilla_timer >= DINO_GODZILLA_LIMIT) {
+        s->godzilla_mode  = 0;
+        s->godzilla_timer = 0;
+    }
+}
+
+/* k cycles in which neither the motion update nor any event fires. */
+static void idle(struct dino_state *s, uint64_t k)
+{
+    s->cycles       += k;
+    s->motion_timer += (uint32_t)k;
+    if (s->godzilla_mode)
+        s->godzilla_timer += k;
+
+    uint64_t frames = wrap_counter_32(&s->frame_counter, DINO_FRAME_LIMIT, k);
+    s->sprite_state = (uint8_t)((s->sprite_state + frames) & 3);
+
+    uint64_t clouds = wrap_counter_32(&s->cloud_counter, DINO_CLOUD_LIMIT, k);
+    if (clouds)
+        s->cloud_offset = (uint16_t)((s->cloud_offset + clouds) % 1282);   // 0..1281
+
+    uint64_t nights = wrap_counter_64(&s->night_timer, DINO_NIGHT_LIMIT, k);
+    s->night_time ^= (uint8_t)(nights & 1);
+}
+
+/* ------------------------------------------------------------------ */
+void dino_sim_cycle(struct dino_state *s)
+{
+    cycle(s);
+}
+
+void dino_sim_write(struct dino_state *s, unsigned address, uint32_t writedata)
+{
+    /* the lfsr block doesn't look at chipselect */
+    if (!s->game_over && s->motion_timer >= DINO_MOTION_LIMIT)
+        s->lfsr = lfsr_next(s->lfsr);
+
+    switch (address & 0x1FF) {
+    case DINO_REG_DINO_X:  s->dino_x        = writedata & 0x3FF; break;
+    case DINO_REG_DINO_Y:  s->dino_y        = writedata & 0x3FF; break;
+    case DINO_REG_DUCKING: s->ducking       = writedata & 1;     break;
+    case DINO_REG_JUMPING: s->jumping       = writedata & 1;     break;
+    case DINO_REG_LAVA_X:  s->lava_x        = writedata & 0x3FF; break;
+    case DINO_REG_LAVA_Y:  s->lava_y        = writedata & 0x3FF; break;
+    case DINO_REG_REPLAY:  s->replay_button = writedata & 1;     break;
+    default: break;
+    }
+    s->cycles++;
+}
+
+/* Runs n clocks, or with stop_at_over only up to and including the clock
+   that sets game_over; returns the clocks run. */
+static uint64_t run(struct dino_state *s, uint64_t n, int stop_at_over)
+{
+    uint64_t left = n;
+
+    while (left) {
+        if (s->game_over && !s->replay_button) {
+            s->cycles += left;                  /* frozen until replay */
+            return n;
+        }
+        if (s->game_over || !quiet(s) || s->motion_timer >= DINO_MOTION_LIMIT) {
+            uint8_t over = s->game_over;
+
+            cycle(s);
+            left--;
+            if (stop_at_over && s->game_over && !over)
+                return n - left;
+            continue;
+        }
+
+        /* quiet: jump to just before the next motion update / timeout */
+        uint64_t k = DINO_MOTION_LIMIT - s->motion_timer;
+        if (s->godzilla_mode) {
+            uint64_t rest = s->godzilla_timer < DINO_GODZILLA_LIMIT
+                          ? DINO_GODZILLA_LIMIT - s->godzilla_timer : 0;
+            if (rest < k) k = rest;
+        }
+        if (k > left) k = left;
+
+        if (k == 0) {
+            cycle(s);
+            left--;
+            if (stop_at_over && s->game_over)
+                return n - left;
+        } else {
+            idle(s, k);
+            left -= k;
+        }
+    }
+    return n;
+}
+
+void dino_sim_run(struct dino_state *s, uint64_t n)
+{
+    run(s, n, 0);
+}
+
+uint64_t dino_sim_run_until_over(struct dino_state *s, uint64_t n)
+{
+    return run(s, n, 1);
+}
+
+/* ------------------------------------------------------------------ */
+/*  event skipping                                                     */
+
+/* Digit k > 0 is bumped by the update at n = 11*10^(k-1)*i + k-2 (i >= 1)
+   and reads 10 only in the state right after its tenth bump. */
+static void bcd_from_ticks(uint8_t *bcd, uint64_t n)
+{
+    uint64_t p = 11;
+
+    bcd[0] = (uint8_t)(n % 11);
+    for (int k = 1; k < DINO_N_DIGITS; k++, p *= 10) {
+        uint64_t c = n + 1 >= (uint64_t)k ? (n + 1 - k) / p : 0;
+        if (c && c % 10 == 0 && n == p * c + k - 1)
+            bcd[k] = 10;
+        else
+            bcd[k] = (uint8_t)(c % 10);
+    }
+}
+
+static int64_t inverse_mod(int64_t a, int64_t m)
+{
+    int64_t t = 0, nt = 1, r = m, nr = a;
+
+    while (nr) {
+        int64_t q = r / nr, tmp;
+        tmp = t - q * nt; t = nt; nt = tmp;
+        tmp = r - q * nr; r = nr; nr = tmp;
+    }
+    return t < 0 ? t + m : t;
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+    while (b) { uint64_t t = a % b; a = b; b = t; }
+    return a;
+}
+
+/* How many j in [0, len) have j == a (mod p) and j == b (mod q). */
+static uint64_t coincidences(uint64_t a, uint64_t p, uint64_t b, uint64_t q, uint64_t len)
+{
+    uint64_t g = gcd(p, q);
+    int64_t  d = (int64_t)b - (int64_t)a;
+
+    if (d % (int64_t)g)
+        return 0;
+
+    int64_t  qg = (int64_t)(q / g);
+    int64_t  t  = (d / (int64_t)g) % qg;
+    if (t < 0) t += qg;
+    t = (int64_t)((unsigned __int128)t * inverse_mod((int64_t)(p / g) % qg, qg) % qg);
+
+    uint64_t first  = a + p * (uint64_t)t;
+    uint64_t period = p / g * q;
+    return first < len ? (len - 1 - first) / period + 1 : 0;
+}
+
+/* Motion updates obstacle x can take before it respawns or the dino's
+   collide() could see it. */
+static uint64_t clear_ticks(const struct dino_state *s, unsigned x, unsigned y,
+                            unsigned aw)
+{
+    unsigned sp = s->obstacle_speed;
+    unsigned lo = sp;
+
+    aw &= 0x3F;
+    if (s->dino_y < ((y + 32) & 0x7FF) && ((s->dino_y + 32) & 0x7FF) > y) {
+        unsigned a = (s->dino_x + aw) & 0x7FF;    /* safe while x >= a */
+        if (a > 0 && a - 1 > lo)
+            lo = a - 1;
+    }
+    if (x <= lo)
+        return 0;
+    if (sp == 0)
+        return UINT64_MAX;
+    return (x - lo - 1) / sp;
+}
+
+uint64_t dino_sim_skip(struct dino_state *s, uint64_t max)
+{
+    if (s->game_over || s->passed_count >= 12 ||
+        s->motion_timer > DINO_MOTION_LIMIT || !quiet(s))
+        return 0;
+
+    uint64_t m = max, c;
+    if ((c = clear_ticks(s, s->s_cac_x,   s->s_cac_y,   32)) < m) m = c;
+    if ((c = clear_ticks(s, s->group_x,   s->group_y,   64)) < m) m = c;
+    if ((c = clear_ticks(s, s->lava_x,    s->lava_y,    32)) < m) m = c;
+    if ((c = clear_ticks(s, s->ptr_x,     s->ptr_y,     32)) < m) m = c;
+    if ((c = clear_ticks(s, s->powerup_x, s->powerup_y, 32)) < m) m = c;
+
+    if (s->godzilla_mode) {
+        uint64_t left = s->godzilla_timer < DINO_GODZILLA_LIMIT
+                      ? DINO_GODZILLA_LIMIT - s->godzilla_timer : 0;
+        if (left / DINO_MOTION_PERIOD < m)
+            m = left / DINO_MOTION_PERIOD;
+    }
+    if (m == 0)
+        return 0;
+
+    uint64_t len  = m * DINO_MOTION_PERIOD;
+    uint16_t dist = (uint16_t)(m * s->obstacle_speed);
+
+    s->s_cac_x   -= dist;
+    s->group_x   -= dist;
+    s->lava_x    -= dist;
+    s->ptr_x     -= dist;
+    s->powerup_x -= dist;
+
+    for (uint64_t i = m % 63; i; i--)          /* maximal length, period 63 */
+        s->lfsr = lfsr_next(s->lfsr);
+
+    s->score_ticks += m;
+    s->score = (uint32_t)((s->score + m) % 100000);
+    bcd_from_ticks(s->bcd, s->score_ticks);
+
+    /* the motion update and frame_counter both bump sprite_state; when
+       they land on the same clock it only moves once */
+    uint64_t both = coincidences(DINO_MOTION_LIMIT - s->motion_timer, DINO_MOTION_PERIOD,
+                                 DINO_FRAME_LIMIT - s->frame_counter, DINO_FRAME_LIMIT + 1,
+                                 len);
+    uint64_t frames = wrap_counter_32(&s->frame_counter, DINO_FRAME_LIMIT, len);
+    s->sprite_state = (uint8_t)((s->sprite_state + m + frames - both) & 3);
+
+    uint64_t clouds = wrap_counter_32(&s->cloud_counter, DINO_CLOUD_LIMIT, len);
+    s->cloud_offset = (uint16_t)((s->cloud_offset + clouds) % 1282);
+
+    uint64_t nights = wrap_counter_64(&s->night_timer, DINO_NIGHT_LIMIT, len);
+    s->night_time ^= (uint8_t)(nights & 1);
+
+    if (s->godzilla_mode)
+        s->godzilla_timer += len;
+    s->cycles += len;                           /* motion_timer ends where it began */
+    return m;
+}
+
+uint64_t dino_sim_ticks(struct dino_state *s, uint64_t n)
+{
+    uint64_t done = 0;
+
+    while (done < n) {
+        if (s->game_over && !s->replay_button) {
+            dino_sim_run(s, (n - done) * DINO_MOTION_PERIOD);
+            return n;
+        }
+        uint64_t k = dino_sim_skip(s, n - done);
+        if (k == 0) {
+            dino_sim_tick(s);
+            k = 1;
+        }
+        done += k;
+        if (s->game_over)
+            break;
+    }
+    return done;
+}
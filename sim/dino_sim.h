@@ -0,0 +1,130 @@
+#ifndef DINO_SIM_H
+#define DINO_SIM_H
+
+#include <stdint.h>
+
+/* Headless model of the game logic in final/vga_ball.sv.
+ *
+ * Everything the RTL keeps in registers is here with the same widths and
+ * the same update rules, including the quirks (11-bit respawn wrap, the
+ * 6-bit collide() widths, the truncated godzilla limit, the bcd carry
+ * lag).  Nothing about video timing is modelled: the state advances in
+ * 50 MHz clock cycles, normally one motion period at a time.
+ */
+
+#define DINO_HACTIVE          1280
+#define DINO_SMASHED_X        2000
+
+/* The timer limits can be overridden (-D) to match an RTL built with
+   scaled-down literals; see vga_check_fast in the Makefile. */
+#ifndef DINO_MOTION_LIMIT
+#define DINO_MOTION_LIMIT     2000000u          // motion_timer >= this moves obstacles
+#endif
+#define DINO_MOTION_PERIOD    (DINO_MOTION_LIMIT + 1)
+#ifndef DINO_FRAME_LIMIT
+#define DINO_FRAME_LIMIT      5000000u          // frame_counter == this bumps sprite_state
+#endif
+#ifndef DINO_CLOUD_LIMIT
+#define DINO_CLOUD_LIMIT      8000000u
+#endif
+#ifndef DINO_NIGHT_LIMIT
+#define DINO_NIGHT_LIMIT      1500000000ull
+#endif
+#ifndef DINO_GODZILLA_LIMIT
+/* 32'd100_000_000_000 in the RTL; the literal is cut to 32 bits. */
+#define DINO_GODZILLA_LIMIT   (100000000000ull & 0xFFFFFFFFull)
+#endif
+
+#define DINO_N_DIGITS         5
+
+/* Avalon word addresses decoded by vga_ball */
+enum {
+    DINO_REG_DINO_X  = 0,
+    DINO_REG_DINO_Y  = 1,
+    DINO_REG_DUCKING = 13,
+    DINO_REG_JUMPING = 14,
+    DINO_REG_LAVA_X  = 17,
+    DINO_REG_LAVA_Y  = 18,
+    DINO_REG_REPLAY  = 19,
+};
+
+struct dino_state {
+    /* written over Avalon */
+    uint16_t dino_x, dino_y;
+    uint8_t  ducking, jumping, replay_button;
+
+    /* obstacles (11-bit positions) */
+    uint16_t s_cac_x,   s_cac_y;
+    uint16_t group_x,   group_y;
+    uint16_t lava_x,    lava_y;
+    uint16_t ptr_x,     ptr_y;
+    uint16_t powerup_x, powerup_y;
+
+    uint16_t obstacle_speed;     // 11 bits
+    uint8_t  passed_count;       // 5 bits
+    uint8_t  lfsr;               // 6 bits
+    uint8_t  game_over;
+    uint8_t  godzilla_mode;
+    uint8_t  sprite_state;       // 2 bits
+    uint8_t  night_time;
+
+    uint8_t  bcd[DINO_N_DIGITS]; // [0] = units
+    uint32_t score;              // 17 bits, wraps after 99999
+
+    uint32_t motion_timer;       // 24 bits
+    uint32_t frame_counter;      // 24 bits
+    uint32_t cloud_counter;      // 24 bits
+    uint16_t cloud_offset;       // 11 bits
+    uint64_t night_timer;        // 40 bits
+    uint64_t godzilla_timer;     // 40 bits
+
+    uint64_t cycles;             // clocks simulated since init
+    uint64_t score_ticks;        // motion updates since replay (not in the RTL)
+};
+
+/* Power-on / KEY reset. */
+void dino_sim_init(struct dino_state *s);
+
+/* One Avalon write cycle (address is the word address). */
+void dino_sim_write(struct dino_state *s, unsigned address, uint32_t writedata);
+
+/* Advances n clock cycles with no bus traffic. */
+void dino_sim_run(struct dino_state *s, uint64_t n);
+
+/* Like dino_sim_run(), but stops after the clock that sets game_over and
+ * returns the clocks run (n if it never did).  With REPLAY held the game
+ * over lasts a single clock, which a plain dino_sim_run() steps past. */
+uint64_t dino_sim_run_until_over(struct dino_state *s, uint64_t n);
+
+/* Exactly one clock, the slow way.  Reference for checking dino_sim_run(). */
+void dino_sim_cycle(struct dino_state *s);
+
+/* One motion period (DINO_MOTION_PERIOD cycles). */
+static inline void dino_sim_tick(struct dino_state *s)
+{
+    dino_sim_run(s, DINO_MOTION_PERIOD);
+}
+
+/* Event skipping.  Between respawns, collisions, speed-ups and the
+ * godzilla timeout the obstacles only slide left, so whole runs of motion
+ * updates can be applied at once.  dino_sim_skip() jumps as many whole
+ * ticks (at most max) as are provably event-free and returns how many;
+ * 0 means the next tick has to be stepped.  The result is identical to
+ * calling dino_sim_tick() that many times.
+ */
+uint64_t dino_sim_skip(struct dino_state *s, uint64_t max);
+
+/* Up to n ticks, skipping where it can; stops after the tick that sets
+   game_over.  Returns the ticks done. */
+uint64_t dino_sim_ticks(struct dino_state *s, uint64_t n);
+
+/* vga_ball.sv's collide(): operands are 11 bits, sizes 6 bits. */
+static inline int dino_collide(unsigned ax, unsigned ay, unsigned bx, unsigned by,
+                               unsigned aw, unsigned ah, unsigned bw, unsigned bh)
+{
+    aw &= 0x3F; ah &= 0x3F; bw &= 0x3F; bh &= 0x3F;
+    return ax < ((bx + bw) & 0x7FF) && ((ax + aw) & 0x7FF) > bx &&
+           ay < ((by + bh) & 0x7FF) && ((ay + ah) & 0x7FF) > by;
+}
+
+#endif
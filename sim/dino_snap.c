@@ -0,0 +1,25 @@
+#include "dino_snap.h"
+#include <stdlib.h>
+
+int dino_snap_ring_init(struct dino_snap_ring *r, uint32_t capacity)
+{
+    void *slots;
+
+    memset(r, 0, sizeof *r);
+    if (capacity == 0 || (capacity & (capacity - 1)))
+        return -1;
+    if (posix_memalign(&slots, 64, (size_t)capacity * sizeof(struct dino_snapshot)))
+        return -1;
+
+    /* touch it now so the first laps don't page-fault */
+    memset(slots, 0, (size_t)capacity * sizeof(struct dino_snapshot));
+    r->slots = slots;
+    r->mask  = capacity - 1;
+    return 0;
+}
+
+void dino_snap_ring_free(struct dino_snap_ring *r)
+{
+    free(r->slots);
+    r->slots = NULL;
+}
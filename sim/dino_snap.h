@@ -0,0 +1,82 @@
+#ifndef DINO_SNAP_H
+#define DINO_SNAP_H
+
+#include <stdint.h>
+#include <string.h>
+#include "dino_sim.h"
+#include "../controller/dino_physics.h"
+
+/* Whole-game snapshots: the RTL model (obstacles, lfsr, speed, score and
+ * bcd, godzilla and night timers, everything else in dino_state) plus
+ * the controller's jump state.  Plain structs, so saving and restoring
+ * is one fixed-size copy.
+ */
+
+struct dino_snapshot {
+    struct dino_state game;
+    struct dino       dino;
+    uint64_t          tag;          // caller's, e.g. the tick it was taken at
+};
+
+static inline void dino_snap_save(struct dino_snapshot *out, const struct dino_state *s,
+                                  const struct dino *d, uint64_t tag)
+{
+    out->game = *s;
+    out->dino = *d;
+    out->tag  = tag;
+}
+
+static inline void dino_snap_restore(const struct dino_snapshot *in, struct dino_state *s,
+                                     struct dino *d)
+{
+    *s = in->game;
+    *d = in->dino;
+}
+
+/* Preallocated ring of the last `capacity` snapshots; pushing onto a
+   full ring overwrites the oldest. */
+struct dino_snap_ring {
+    struct dino_snapshot *slots;
+    uint32_t mask;
+    uint32_t head;                  // next slot to write
+    uint32_t count;                 // valid snapshots, at most mask + 1
+};
+
+/* capacity must be a power of two.  Returns 0 or -1 (no memory). */
+int  dino_snap_ring_init(struct dino_snap_ring *r, uint32_t capacity);
+void dino_snap_ring_free(struct dino_snap_ring *r);
+
+static inline void dino_snap_push(struct dino_snap_ring *r, const struct dino_state *s,
+                                  const struct dino *d, uint64_t tag)
+{
+    dino_snap_save(&r->slots[r->head & r->mask], s, d, tag);
+    r->head++;
+    if (r->count <= r->mask)
+        r->count++;
+}
+
+/* The k-th newest snapshot (0 = last pushed), or NULL if there isn't one. */
+static inline const struct dino_snapshot *dino_snap_back(const struct dino_snap_ring *r,
+                                                         uint32_t k)
+{
+    if (k >= r->count)
+        return NULL;
+    return &r->slots[(r->head - 1 - k) & r->mask];
+}
+
+/* Restores the k-th newest snapshot and forgets the ones after it, so the
+   next push continues from there.  Returns -1 if there is none. */
+static inline int dino_snap_rollback(struct dino_snap_ring *r, uint32_t k,
+                                     struct dino_state *s, struct dino *d)
+{
+    const struct dino_snapshot *snap = dino_snap_back(r, k);
+
+    if (!snap)
+        return -1;
+    dino_snap_restore(snap, s, d);
+    r->head  -= k;
+    r->count -= k;
+    return 0;
+}
+
+#endif
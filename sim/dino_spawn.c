@@ -0,0 +1,450 @@
+/*  dino_spawn.c – every obstacle sequence the game can produce, checked
+ *  for gaps the dino can't jump
+ *
+ *  The lfsr runs through all 63 non-zero states and replay doesn't reset
+ *  it, so a game can start from any of them; from there the obstacles
+ *  are fixed until the dino touches something.  For each start state
+ *  (and each dino x asked for) the obstacle run is simulated up to a
+ *  speed limit and every pass of a ground obstacle over the dino is
+ *  checked: is there a jump, started after the previous pass and using
+ *  the controller's real jump (controller/dino_physics.h, including the
+ *  10-bit y wrap), that clears it without touching anything else?  The
+ *  obstacle has to pass the x the jump takes the dino to while the dino
+ *  is up, and the dino, back on the ground there, has to stay clear
+ *  until the pass is over.
+ *
+ *  Powerups are left out (picking one up only makes things easier) and
+ *  each pass is judged with the dino on the ground at x beforehand, so a
+ *  run of jumps that drifts the dino right by 23 px each is not followed.
+ */
+
+#include "dino_sim.h"
+#include "dino_play.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_SPEED     2047
+#define MAX_X         8
+#define MAX_EXAMPLES  12
+#define STEP_MS       (1000.0 / PHYSICS_HZ)
+
+enum { S_CAC, GROUP, LAVA, PTR, N_OBST };
+static const char *obst_name[N_OBST] = { "s_cac", "group", "lava", "ptr" };
+
+/* gap before a pass, in physics steps */
+static const unsigned gap_edge[] = { 50, 100, 200, 400, 1000, 2000 };
+#define N_GAP (sizeof gap_edge / sizeof gap_edge[0] + 1)
+
+/* ------------------------------------------------------------------ */
+/*  the jump, as danger intervals relative to its first step           */
+
+struct span { unsigned lo, hi; };
+
+static struct {
+    unsigned    len;                    /* steps until it's back on the ground */
+    unsigned    n_ground, n_ptr;
+    struct span ground[16], ptr[16];
+} jump;
+
+static void add_span(struct span *v, unsigned *n, int *open, int now, unsigned k)
+{
+    if (now && !*open)
+        v[*n].lo = k;
+    if (!now && *open)
+        v[(*n)++].hi = k;
+    *open = now;
+}
+
+static void trace_jump(void)
+{
+    struct dino d = { .x = 0, .y_fixed = GROUND_Y_FIXED };
+    int in_g = 0, in_p = 0;
+    unsigned k = 0;
+
+    physics_step(&d, true);
+    for (;; k++) {
+        unsigned ay = (unsigned)(d.y_fixed >> FIXED_SHIFT) & 0x3FF;
+        if (d.y_fixed == GROUND_Y_FIXED)
+            break;
+        add_span(jump.ground, &jump.n_ground, &in_g, dino_collide(0, ay, 0, 248, 32, 32, 32, 32), k);
+        add_span(jump.ptr,    &jump.n_ptr,    &in_p, dino_collide(0, ay, 0, 200, 32, 32, 32, 32), k);
+        physics_step(&d, false);
+    }
+    add_span(jump.ground, &jump.n_ground, &in_g, 0, k);
+    add_span(jump.ptr,    &jump.n_ptr,    &in_p, 0, k);
+    jump.len = k;
+}
+
+/* ------------------------------------------------------------------ */
+/*  results                                                            */
+
+struct example {
+    uint8_t  seed;
+    uint16_t x, speed;
+    uint32_t tick;
+    uint8_t  who;                       /* obstacles in the pass, bit per enum */
+    uint32_t gap;                       /* steps since the previous pass */
+};
+
+struct stats {
+    uint64_t states;                    /* (lfsr, speed, layout) visited */
+    uint64_t spawns[N_OBST], wrapped[N_OBST];
+    uint64_t passes[MAX_SPEED + 1], unfair[MAX_SPEED + 1];
+    uint64_t gaps[MAX_SPEED + 1][N_GAP];
+    uint64_t unfair_who[16];
+    unsigned n_examples;
+    struct example examples[MAX_EXAMPLES];
+};
+
+static int example_before(const struct example *a, const struct example *b)
+{
+    if (a->seed != b->seed) return a->seed < b->seed;
+    if (a->x != b->x)       return a->x < b->x;
+    return a->tick < b->tick;
+}
+
+/* Keeps the first MAX_EXAMPLES by (seed, x, tick), in that order, so
+   which ones are printed doesn't depend on how the threads ran.  A run
+   records its earliest ticks, so none of those can be missing. */
+static void add_example(struct stats *to, const struct example *e)
+{
+    unsigned i = to->n_examples;
+
+    if (i == MAX_EXAMPLES && !example_before(e, &to->examples[--i]))
+        return;
+    while (i > 0 && example_before(e, &to->examples[i - 1])) {
+        to->examples[i] = to->examples[i - 1];
+        i--;
+    }
+    to->examples[i] = *e;
+    if (to->n_examples < MAX_EXAMPLES)
+        to->n_examples++;
+}
+
+static void merge(struct stats *to, const struct stats *from, unsigned max_speed)
+{
+    to->states += from->states;
+    for (int o = 0; o < N_OBST; o++) {
+        to->spawns[o]  += from->spawns[o];
+        to->wrapped[o] += from->wrapped[o];
+    }
+    for (unsigned sp = 0; sp <= max_speed; sp++) {
+        to->passes[sp] += from->passes[sp];
+        to->unfair[sp] += from->unfair[sp];
+        for (unsigned g = 0; g < N_GAP; g++)
+            to->gaps[sp][g] += from->gaps[sp][g];
+    }
+    for (int w = 0; w < 16; w++)
+        to->unfair_who[w] += from->unfair_who[w];
+    for (unsigned i = 0; i < from->n_examples; i++)
+        add_example(to, &from->examples[i]);
+}
+
+/* ------------------------------------------------------------------ */
+/*  one start state                                                    */
+
+struct run {
+    uint32_t  ticks;
+    uint16_t *x[N_OBST];                /* after m motion updates */
+    uint16_t *speed;
+    uint32_t *g_pre, *p_pre;            /* prefix sums over steps, dino at x + JUMP_DX */
+};
+
+static int ground_hit(const struct run *r, uint32_t m, unsigned ax, unsigned *who)
+{
+    static const unsigned aw[N_OBST] = { 32, 64, 32, 32 };
+    unsigned w = 0;
+
+    for (int o = 0; o < PTR; o++)
+        if (dino_collide(ax, 248, r->x[o][m], 248, aw[o], 32, 32, 32))
+            w |= 1u << o;
+    if (who)
+        *who = w;
+    return w != 0;
+}
+
+static int ptr_hit(const struct run *r, uint32_t m, unsigned ax)
+{
+    return dino_collide(ax, 200, r->x[PTR][m], 200, 32, 32, 32, 32);
+}
+
+static int span_clear(const uint32_t *pre, uint64_t lo, uint64_t hi, uint64_t end)
+{
+    if (lo >= end)
+        return 1;
+    if (hi > end)
+        hi = end;
+    return pre[hi] == pre[lo];
+}
+
+/* Some start in [lo, hi] gets over the pass that ends at step pass_end?
+   Seen at the jump's x, the pass's contact has to lie inside the time in
+   the air: nothing there before the start, nothing in the low parts of
+   the jump, and nothing from landing until the pass is over. */
+static int jumpable(const struct run *r, uint64_t lo, uint64_t hi, uint64_t pass_end)
+{
+    uint64_t end = (uint64_t)r->ticks * DINO_PLAY_SUBSTEPS;
+
+    for (uint64_t s = lo; s <= hi; s++) {
+        int ok = span_clear(r->g_pre, lo, s, end);
+        for (unsigned i = 0; ok && i < jump.n_ground; i++)
+            ok = span_clear(r->g_pre, s + jump.ground[i].lo, s + jump.ground[i].hi, end);
+        for (unsigned i = 0; ok && i < jump.n_ptr; i++)
+            ok = span_clear(r->p_pre, s + jump.ptr[i].lo, s + jump.ptr[i].hi, end);
+        if (ok)
+            ok = span_clear(r->g_pre, s + jump.len,
+                            s + jump.len < pass_end ? pass_end : s + jump.len + 1, end);
+        if (ok)
+            return 1;
+    }
+    return 0;
+}
+
+static void simulate(struct run *r, uint8_t seed, unsigned max_speed, uint32_t cap,
+                     struct stats *st)
+{
+    struct dino_state s;
+
+    dino_sim_init(&s);
+    s.lfsr = seed;
+    dino_sim_write(&s, DINO_REG_DINO_Y, 0);     /* out of everyone's way */
+
+    uint32_t m = 0;
+    for (;;) {
+        uint16_t now[N_OBST] = { s.s_cac_x, s.group_x, s.lava_x, s.ptr_x };
+        for (int o = 0; o < N_OBST; o++)
+            r->x[o][m] = now[o];
+        r->speed[m] = s.obstacle_speed;
+        if (++m == cap || s.obstacle_speed > max_speed)
+            break;
+
+        uint16_t sp = s.obstacle_speed;
+        dino_sim_tick(&s);
+        for (int o = 0; o < N_OBST; o++) {
+            if (now[o] > sp)
+                continue;
+            uint16_t after[N_OBST] = { s.s_cac_x, s.group_x, s.lava_x, s.ptr_x };
+            st->spawns[o]++;
+            if (after[o] < DINO_HACTIVE)
+                st->wrapped[o]++;
+        }
+    }
+    r->ticks = m;
+    st->states += m;
+}
+
+static void analyse(struct run *r, uint8_t seed, unsigned x, struct stats *st)
+{
+    uint64_t steps = (uint64_t)r->ticks * DINO_PLAY_SUBSTEPS;
+    unsigned jx = (x + JUMP_DX) & 0x3FF;
+
+    r->g_pre[0] = r->p_pre[0] = 0;
+    for (uint64_t t = 0; t < steps; t++) {
+        uint32_t m = (uint32_t)(t / DINO_PLAY_SUBSTEPS);
+        r->g_pre[t + 1] = r->g_pre[t] + ground_hit(r, m, jx, NULL);
+        r->p_pre[t + 1] = r->p_pre[t] + ptr_hit(r, m, jx);
+    }
+
+    /* passes over the standing dino: runs of ticks with a ground hit */
+    uint64_t free_from = 0;
+    for (uint32_t m = 0; m < r->ticks; ) {
+        unsigned who;
+        if (!ground_hit(r, m, x, &who)) {
+            m++;
+            continue;
+        }
+        uint32_t e = m;
+        unsigned all = who;
+        while (m < r->ticks && ground_hit(r, m, x, &who))
+            all |= who, m++;
+
+        uint64_t start = (uint64_t)e * DINO_PLAY_SUBSTEPS;
+        uint64_t gap = start - free_from;
+        unsigned sp = r->speed[e], g = 0;
+
+        while (g < N_GAP - 1 && gap >= gap_edge[g])
+            g++;
+        st->passes[sp]++;
+        st->gaps[sp][g]++;
+
+        /* a jump has to be under way before the first contact */
+        if (start == 0 ||
+            !jumpable(r, free_from, start - 1, (uint64_t)m * DINO_PLAY_SUBSTEPS)) {
+            st->unfair[sp]++;
+            st->unfair_who[all]++;
+            if (st->n_examples < MAX_EXAMPLES)
+                st->examples[st->n_examples++] = (struct example){
+                    seed, (uint16_t)x, (uint16_t)sp, e, (uint8_t)all, (uint32_t)gap };
+        }
+        free_from = (uint64_t)m * DINO_PLAY_SUBSTEPS;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  threads                                                            */
+
+struct job {
+    unsigned max_speed;
+    uint32_t cap;                       /* ticks per run at most */
+    unsigned n_x, xs[MAX_X];
+    unsigned next;                      /* atomic: seed * n_x + x index */
+    pthread_mutex_t lock;
+    struct stats total;
+};
+
+static void *worker(void *arg)
+{
+    struct job *job = arg;
+    struct stats *st = calloc(1, sizeof *st);
+    struct run r;
+
+    for (int o = 0; o < N_OBST; o++)
+        r.x[o] = malloc(job->cap * sizeof *r.x[o]);
+    r.speed = malloc(job->cap * sizeof *r.speed);
+    r.g_pre = malloc(((size_t)job->cap * DINO_PLAY_SUBSTEPS + 1) * sizeof *r.g_pre);
+    r.p_pre = malloc(((size_t)job->cap * DINO_PLAY_SUBSTEPS + 1) * sizeof *r.p_pre);
+
+    for (;;) {
+        unsigned w = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (w >= 63 * job->n_x)
+            break;
+        uint8_t seed = (uint8_t)(w / job->n_x + 1);
+        unsigned xi = w % job->n_x;
+
+        struct stats one;
+        memset(&one, 0, sizeof one);
+        simulate(&r, seed, job->max_speed, job->cap, &one);
+        if (xi)
+            memset(one.spawns, 0, sizeof one.spawns + sizeof one.wrapped),
+            one.states = 0;             /* count each run once */
+        analyse(&r, seed, job->xs[xi], &one);
+        merge(st, &one, job->max_speed);
+    }
+
+    pthread_mutex_lock(&job->lock);
+    merge(&job->total, st, job->max_speed);
+    pthread_mutex_unlock(&job->lock);
+
+    for (int o = 0; o < N_OBST; o++)
+        free(r.x[o]);
+    free(r.speed);
+    free(r.g_pre);
+    free(r.p_pre);
+    free(st);
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+
+static void who_str(char *buf, unsigned who)
+{
+    buf[0] = 0;
+    for (int o = 0; o < N_OBST; o++)
+        if (who & (1u << o)) {
+            if (buf[0]) strcat(buf, "+");
+            strcat(buf, obst_name[o]);
+        }
+}
+
+static void report(const struct job *job, double secs)
+{
+    const struct stats *st = &job->total;
+    char who[64];
+
+    printf("jump: %u steps (%.0f ms) in the air; clear of ground obstacles for",
+           jump.len, jump.len * STEP_MS);
+    for (unsigned i = 0; i + 1 < jump.n_ground; i++)
+        printf(" [%u,%u)", jump.ground[i].hi, jump.ground[i + 1].lo);
+    printf(" steps\n");
+
+    printf("runs: 63 lfsr starts x %u dino x, up to speed %u: %llu states in %.2f s\n",
+           job->n_x, job->max_speed, (unsigned long long)st->states, secs);
+
+    printf("spawns (x past 2047 wraps onto the screen):\n");
+    for (int o = 0; o < PTR + 1; o++)
+        printf("  %-6s %8llu spawned, %6llu wrapped (%.1f%%)\n", obst_name[o],
+               (unsigned long long)st->spawns[o], (unsigned long long)st->wrapped[o],
+               st->spawns[o] ? 100.0 * st->wrapped[o] / st->spawns[o] : 0.0);
+
+    printf("passes by speed; gap before each pass in ms: <");
+    for (unsigned g = 0; g < N_GAP - 1; g++)
+        printf("%s%.0f", g ? " <" : "", gap_edge[g] * STEP_MS);
+    printf(" more\n");
+    for (unsigned sp = 0; sp <= job->max_speed; sp++) {
+        if (!st->passes[sp])
+            continue;
+        printf("  speed %3u: %7llu passes, %6llu unjumpable (%5.1f%%) |", sp,
+               (unsigned long long)st->passes[sp], (unsigned long long)st->unfair[sp],
+               100.0 * st->unfair[sp] / st->passes[sp]);
+        for (unsigned g = 0; g < N_GAP; g++)
+            printf(" %6llu", (unsigned long long)st->gaps[sp][g]);
+        printf("\n");
+    }
+
+    printf("unjumpable passes by obstacles involved:\n");
+    for (unsigned w = 1; w < 16; w++)
+        if (st->unfair_who[w]) {
+            who_str(who, w);
+            printf("  %-22s %llu\n", who, (unsigned long long)st->unfair_who[w]);
+        }
+
+    if (st->n_examples)
+        printf("examples (lfsr at replay, dino x, tick after replay):\n");
+    for (unsigned i = 0; i < st->n_examples; i++) {
+        const struct example *e = &st->examples[i];
+        who_str(who, e->who);
+        printf("  lfsr %02x x %4u tick %6u speed %3u: %-16s after %u ms clear\n",
+               e->seed, e->x, e->tick, e->speed, who, (unsigned)(e->gap * STEP_MS));
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-s MAX_SPEED] [-x DINO_X]... [-j THREADS]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    static struct job job;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    job.max_speed = 16;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            job.max_speed = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc && job.n_x < MAX_X)
+            job.xs[job.n_x++] = strtoul(argv[++i], NULL, 0) & 0x3FF;
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            threads = strtol(argv[++i], NULL, 0);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!job.n_x)
+        job.xs[job.n_x++] = 100;
+    if (job.max_speed < 1) job.max_speed = 1;
+    if (job.max_speed > MAX_SPEED - 1) job.max_speed = MAX_SPEED - 1;
+    if (threads < 1) threads = 1;
+
+    /* speed goes up once per 13 passes; this is plenty for any limit */
+    job.cap = 200000 + 20000 * job.max_speed;
+    if (job.cap > 4000000) job.cap = 4000000;
+    pthread_mutex_init(&job.lock, NULL);
+    trace_jump();
+
+    struct timespec t0, t1;
+    pthread_t tid[threads];
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (long t = 0; t < threads; t++)
+        pthread_create(&tid[t], NULL, worker, &job);
+    for (long t = 0; t < threads; t++)
+        pthread_join(tid[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    report(&job, (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+    return 0;
+}
@@ -0,0 +1,255 @@
+/*  vga_check.cpp – dino_sim against the RTL, clock for clock
+ *
+ *  Each lane is a Verilator build of final/vga_ball.sv and a dino_state
+ *  started from the same reset.  Both get the same Avalon writes
+ *  (dino_x/y, ducking, jumping, replay) at the same clock, at random
+ *  points in the motion period; after every motion period the game
+ *  state is read out of the RTL and compared.  The first difference
+ *  stops every lane and prints both sides.
+ *
+ *  Lanes are independent, one per thread.  Built as vga_check_fast the
+ *  RTL's timer literals are cut by 1000 (and dino_sim is compiled with
+ *  the same limits) so a tick is 2001 clocks instead of 2000001.
+ *
+ *  Not yet run against a real Verilator build: only against a stand-in
+ *  model wrapped around dino_sim.  The vga_ball__DOT__ names read_rtl()
+ *  uses are Verilator's usual flattening, not checked output, and how
+ *  many ticks a lane manages hasn't been measured.
+ *
+ *    ./vga_check -t 100000 -j 8        # reproduce a lane: -s SEED -j 1
+ */
+
+#include "vga_rtl.h"
+#include "Vvga_ball.h"
+#include "Vvga_ball___024root.h"
+#include "verilated.h"
+extern "C" {
+#include "dino_sim.h"
+}
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_WRITES 4                    // per motion period
+
+struct job {
+    uint64_t ticks;                     // per lane
+    uint64_t seed;
+    unsigned lanes;
+    unsigned next;                      // atomic
+    volatile int failed;
+    uint64_t done;                      // atomic, ticks compared
+    pthread_mutex_t lock;
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_rand(uint64_t *r)
+{
+    *r ^= *r << 13; *r ^= *r >> 7; *r ^= *r << 17;
+    return *r;
+}
+
+/* What the checker compares, read out of the RTL's registers. */
+static void read_rtl(const VgaRtl &rtl, struct dino_state *s)
+{
+    const Vvga_ball___024root *r = rtl.top->rootp;
+
+    s->s_cac_x        = r->vga_ball__DOT__s_cac_x;
+    s->group_x        = r->vga_ball__DOT__group_x;
+    s->lava_x         = r->vga_ball__DOT__lava_x;
+    s->ptr_x          = r->vga_ball__DOT__ptr_x;
+    s->powerup_x      = r->vga_ball__DOT__powerup_x;
+    s->obstacle_speed = r->vga_ball__DOT__obstacle_speed;
+    s->passed_count   = r->vga_ball__DOT__passed_count;
+    s->lfsr           = r->vga_ball__DOT__lfsr;
+    s->game_over      = r->vga_ball__DOT__game_over;
+    s->godzilla_mode  = r->vga_ball__DOT__godzilla_mode;
+    s->score          = r->vga_ball__DOT__score;
+    s->motion_timer   = r->vga_ball__DOT__motion_timer;
+    for (int i = 0; i < DINO_N_DIGITS; i++)
+        s->bcd[i] = r->vga_ball__DOT__bcd[i];
+}
+
+static int same(const struct dino_state *a, const struct dino_state *b)
+{
+    return a->s_cac_x == b->s_cac_x && a->group_x == b->group_x &&
+           a->lava_x == b->lava_x && a->ptr_x == b->ptr_x &&
+           a->powerup_x == b->powerup_x && a->obstacle_speed == b->obstacle_speed &&
+           a->passed_count == b->passed_count && a->lfsr == b->lfsr &&
+           a->game_over == b->game_over && a->godzilla_mode == b->godzilla_mode &&
+           a->score == b->score && a->motion_timer == b->motion_timer &&
+           !memcmp(a->bcd, b->bcd, sizeof a->bcd);
+}
+
+static void print_state(FILE *f, const char *tag, const struct dino_state *s)
+{
+    fprintf(f, "%s mt=%u lfsr=%02x spd=%u pc=%u s_cac=%u group=%u lava=%u ptr=%u pwr=%u "
+               "score=%u bcd=%u%u%u%u%u go=%u gz=%u\n",
+            tag, s->motion_timer, s->lfsr, s->obstacle_speed, s->passed_count,
+            s->s_cac_x, s->group_x, s->lava_x, s->ptr_x, s->powerup_x, s->score,
+            s->bcd[4], s->bcd[3], s->bcd[2], s->bcd[1], s->bcd[0],
+            s->game_over, s->godzilla_mode);
+}
+
+/* One write for this point in the game: mostly the dino parked out of
+   the way (y=0) so games run long, sometimes standing in the lanes. */
+static void pick_write(uint64_t *rng, const struct dino_state *m,
+                       unsigned *address, uint32_t *data)
+{
+    uint64_t r = next_rand(rng);
+
+    if (m->game_over) {
+        *address = DINO_REG_REPLAY;
+        *data = r & 1;
+        return;
+    }
+    switch ((r >> 1) % 8) {
+    case 0: *address = DINO_REG_DUCKING; *data = (r >> 8) & 1; break;
+    case 1: *address = DINO_REG_JUMPING; *data = (r >> 8) & 1; break;
+    case 2: *address = DINO_REG_REPLAY;  *data = 0;            break;
+    case 3: case 4:
+        *address = DINO_REG_DINO_X;
+        *data = (r >> 8) % 4 ? 100 : (uint32_t)(r >> 16) & 0x3FF;
+        break;
+    default: {
+        static const uint32_t ys[] = { 0, 0, 0, 0, 0, 248, 200, 120 };
+        *address = DINO_REG_DINO_Y;
+        *data = ys[(r >> 8) % 8];
+        break;
+    }
+    }
+}
+
+static void *lane(void *arg)
+{
+    struct job *job = (struct job *)arg;
+
+    for (;;) {
+        unsigned id = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (id >= job->lanes || job->failed)
+            break;
+
+        uint64_t seed = job->seed + id, rng = seed * 0x9E3779B97F4A7C15ull | 1;
+        VgaRtl rtl;
+        struct dino_state m, hw;
+
+        rtl.capture = false;
+        rtl.reset();
+        dino_sim_init(&m);
+
+        for (uint64_t t = 0; t < job->ticks && !job->failed; t++) {
+            uint64_t at[MAX_WRITES], pos = 0;
+            unsigned n = next_rand(&rng) % (MAX_WRITES + 1);
+
+            for (unsigned i = 0; i < n; i++)
+                at[i] = next_rand(&rng) % DINO_MOTION_PERIOD;
+            for (unsigned i = 1; i < n; i++)    // few enough to insertion sort
+                for (unsigned j = i; j > 0 && at[j] < at[j - 1]; j--) {
+                    uint64_t x = at[j]; at[j] = at[j - 1]; at[j - 1] = x;
+                }
+
+            for (unsigned i = 0; i < n; i++) {
+                unsigned address;
+                uint32_t data;
+
+                if (at[i] > pos) {
+                    rtl.run(at[i] - pos);
+                    dino_sim_run(&m, at[i] - pos);
+                    pos = at[i];
+                }
+                pick_write(&rng, &m, &address, &data);
+                rtl.write(address, data);
+                dino_sim_write(&m, address, data);
+                pos++;
+            }
+            if (pos < DINO_MOTION_PERIOD) {
+                rtl.run(DINO_MOTION_PERIOD - pos);
+                dino_sim_run(&m, DINO_MOTION_PERIOD - pos);
+            }
+
+            hw = m;
+            read_rtl(rtl, &hw);
+            if (!same(&m, &hw)) {
+                pthread_mutex_lock(&job->lock);
+                if (!job->failed) {
+                    job->failed = 1;
+                    printf("mismatch: seed %llu, tick %llu, cycle %llu\n",
+                           (unsigned long long)seed, (unsigned long long)t,
+                           (unsigned long long)rtl.cycles);
+                    print_state(stdout, "model", &m);
+                    print_state(stdout, "rtl  ", &hw);
+                }
+                pthread_mutex_unlock(&job->lock);
+                break;
+            }
+            __atomic_fetch_add(&job->done, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-t TICKS] [-n LANES] [-s SEED] [-j THREADS] [--hex DIR]\n",
+            argv0);
+}
+
+int main(int argc, char **argv)
+{
+    static struct job job;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *hex_dir = "hex";
+
+    job.ticks = 10000;
+    job.seed = 1;
+    job.lanes = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            job.ticks = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            job.lanes = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            job.seed = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            threads = strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--hex") && i + 1 < argc)
+            hex_dir = argv[++i];
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+    if (!job.lanes)
+        job.lanes = threads;
+    if (chdir(hex_dir) < 0) {
+        perror(hex_dir);
+        return 1;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+
+    pthread_t tid[threads];
+    double t0 = now_s();
+    for (long t = 0; t < threads; t++)
+        pthread_create(&tid[t], NULL, lane, &job);
+    for (long t = 0; t < threads; t++)
+        pthread_join(tid[t], NULL);
+    double dt = now_s() - t0;
+
+    printf("%s: %llu ticks in %u lanes of %u clocks, %.2f s on %ld threads: "
+           "%.0f ticks/s (%.2f M/min)\n",
+           job.failed ? "FAILED" : "identical",
+           (unsigned long long)job.done, job.lanes, (unsigned)DINO_MOTION_PERIOD,
+           dt, threads, job.done / dt, job.done / dt * 60 / 1e6);
+    return job.failed;
+}
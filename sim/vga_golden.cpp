@@ -0,0 +1,315 @@
+/*  vga_golden.cpp – the golden frames out of the RTL
+ *
+ *  dino_golden --bus DIR writes, for every scenario, the trace's bus
+ *  writes and the game state under each frame it grabs (DIR/NAME.bus,
+ *  format in dino_golden.c).  This plays one into a Verilator build of
+ *  final/staged/vga_ball.sv with the game logic stalled (VgaRtl::stall):
+ *  writes go over the bus as they came, and for a frame the state is
+ *  poked into the logic's registers, one frame is run so the line
+ *  buffers and the sky pipeline fill from it, and the next is captured
+ *  and compared with the frame golden/NAME.gold has in that place.
+ *  So the sprite path, palettes, mask plane, object engine and sky are
+ *  the RTL's own; the game logic is vga_check's business.
+ *
+ *  Scenarios run in parallel, one model each.  A failing frame is
+ *  written out as DIFF/NAME_rtl_NNN.ppm, full width.
+ *
+ *    ./dino_golden --bus golden-bus && ./vga_golden -b golden-bus
+ */
+
+#include "vga_rtl.h"
+#include "Vvga_ball.h"
+#include "Vvga_ball___024root.h"
+#include "verilated.h"
+extern "C" {
+#include "dino_gold.h"
+}
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_SCENARIOS 256
+
+struct scenario {
+    char     name[256];
+    unsigned frames, bad_frames;
+    uint64_t bad_pixels;
+    int      first_bad;                 // -1 = none
+    char     error[8192];
+};
+
+struct job {
+    char gold_dir[4096], bus_dir[4096], diff_dir[4096];
+    unsigned n;
+    unsigned next;                      // atomic
+    struct scenario *sc[MAX_SCENARIOS];
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* One NAME=VALUE of a frame line into the logic's registers. */
+static int poke(Vvga_ball___024root *r, const char *name, const char *value)
+{
+    unsigned long v = strtoul(value, NULL, 0);
+
+#define SET(f) if (!strcmp(name, #f)) { r->vga_ball__DOT__##f = v; return 0; }
+    SET(dino_x) SET(dino_y) SET(ducking) SET(jumping)
+    SET(s_cac_x) SET(s_cac_y) SET(group_x) SET(group_y) SET(lava_x) SET(lava_y)
+    SET(ptr_x) SET(ptr_y) SET(powerup_x) SET(powerup_y)
+    SET(sprite_state) SET(game_over) SET(godzilla_mode) SET(night_time) SET(cloud_offset)
+#undef SET
+    if (!strcmp(name, "bcd")) {
+        char *p = (char *)value;
+        for (int i = 0; i < 5; i++) {
+            r->vga_ball__DOT__bcd[i] = strtoul(p, &p, 0);
+            if (*p != (i < 4 ? ',' : 0))
+                return -1;
+            p++;
+        }
+        return 0;
+    }
+    return -1;
+}
+
+/* The colours the night block latches on every clock the logic runs. */
+static void poke_sky(Vvga_ball___024root *r)
+{
+    bool night = r->vga_ball__DOT__night_time;
+
+    r->vga_ball__DOT__sky_r = night ? 10 : 135;
+    r->vga_ball__DOT__sky_g = night ? 10 : 206;
+    r->vga_ball__DOT__sky_b = night ? 40 : 235;
+    r->vga_ball__DOT__sun_r = 255;
+    r->vga_ball__DOT__sun_g = 255;
+    r->vga_ball__DOT__sun_b = night ? 255 : 0;
+}
+
+static void play(const struct job *job, struct scenario *sc)
+{
+    char bus_path[8192], gold_path[8192];
+    snprintf(bus_path, sizeof bus_path, "%s/%s.bus", job->bus_dir, sc->name);
+    snprintf(gold_path, sizeof gold_path, "%s/%s.gold", job->gold_dir, sc->name);
+    FILE *bus = fopen(bus_path, "r"), *gold = fopen(gold_path, "rb");
+    uint8_t *want = (uint8_t *)calloc(DINO_GOLD_BYTES, 1);
+    uint8_t *buf = (uint8_t *)malloc(DINO_GOLD_MAX);
+    uint32_t count = 0;
+    char line[1024];
+    int n = 0;
+
+    if (!bus || !gold || !want || !buf || dino_gold_open(gold, &count) < 0) {
+        snprintf(sc->error, sizeof sc->error, "can't read %s or %s", bus_path,
+                 gold_path);
+        goto out;
+    }
+
+    {
+        VgaRtl rtl;
+        rtl.stall(true);
+        rtl.reset();
+
+        while (fgets(line, sizeof line, bus)) {
+            char *save, *tok = strtok_r(line, " \t\n", &save);
+            unsigned address;
+            char value[32];
+
+            n++;
+            if (!tok)
+                continue;
+            if (!strcmp(tok, "write") && sscanf(save, "%u %31s", &address, value) == 2) {
+                rtl.write(address, (uint32_t)strtoul(value, NULL, 0));
+                continue;
+            }
+            if (strcmp(tok, "frame")) {
+                snprintf(sc->error, sizeof sc->error, "%s:%d: can't parse", bus_path, n);
+                goto out;
+            }
+            while ((tok = strtok_r(NULL, " \t\n", &save))) {
+                char *eq = strchr(tok, '=');
+                if (!eq || (*eq = 0, poke(rtl.top->rootp, tok, eq + 1)) < 0) {
+                    snprintf(sc->error, sizeof sc->error, "%s:%d: no register %s",
+                             bus_path, n, tok);
+                    goto out;
+                }
+            }
+            poke_sky(rtl.top->rootp);
+
+            // the frame the line buffers fill in, then the one that's shown
+            rtl.capture = false;
+            rtl.run_frame();
+            rtl.capture = true;
+            rtl.run_frame();
+
+            if (sc->frames == count || dino_gold_next(gold, buf, want) < 0) {
+                snprintf(sc->error, sizeof sc->error, "%s: no frame %u", gold_path,
+                         sc->frames);
+                goto out;
+            }
+            unsigned bad = 0;
+            for (unsigned v = 0; v < DINO_SCREEN_H; v++)
+                for (unsigned h = 0; h < DINO_SCREEN_W; h++)
+                    bad += memcmp(rtl.pixel(h, v), want + 3 * (v * DINO_SCREEN_W + h), 3) != 0;
+            if (bad) {
+                char path[8192];
+                if (!sc->bad_frames++)
+                    sc->first_bad = (int)sc->frames;
+                sc->bad_pixels += bad;
+                snprintf(path, sizeof path, "%s/%s_rtl_%03u.ppm", job->diff_dir,
+                         sc->name, sc->frames);
+                rtl.write_ppm(path, true);
+            }
+            sc->frames++;
+        }
+        if (sc->frames != count)
+            snprintf(sc->error, sizeof sc->error, "%s has %u frames, %s makes %u",
+                     gold_path, count, bus_path, sc->frames);
+    }
+out:
+    if (bus)
+        fclose(bus);
+    if (gold)
+        fclose(gold);
+    free(want);
+    free(buf);
+}
+
+static void *worker(void *arg)
+{
+    struct job *job = (struct job *)arg;
+
+    for (;;) {
+        unsigned i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= job->n)
+            break;
+        play(job, job->sc[i]);
+    }
+    return NULL;
+}
+
+static int add_scenario(struct job *job, const char *name)
+{
+    struct scenario *sc;
+    size_t len = strlen(name);
+
+    if (len > 4 && !strcmp(name + len - 4, ".bus"))
+        len -= 4;
+    if (job->n == MAX_SCENARIOS || len >= sizeof sc->name ||
+        !(sc = (struct scenario *)calloc(1, sizeof *sc)))
+        return -1;
+    memcpy(sc->name, name, len);
+    sc->first_bad = -1;
+    job->sc[job->n++] = sc;
+    return 0;
+}
+
+static int by_name(const void *a, const void *b)
+{
+    return strcmp((*(struct scenario *const *)a)->name, (*(struct scenario *const *)b)->name);
+}
+
+/* the models $readmemh from the hex directory, so everything else is
+   made absolute before going there */
+static void absolute(char *out, const char *cwd, const char *path)
+{
+    snprintf(out, 4096, "%s%s%s", path[0] == '/' ? "" : cwd, path[0] == '/' ? "" : "/", path);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-b BUSDIR] [-d GOLDDIR] [-j THREADS] [--hex DIR] [--diff DIR] "
+                    "[SCENARIO]...\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    static struct job job;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *hex_dir = "hex", *gold_dir = "golden", *bus_dir = "golden-bus";
+    const char *diff_dir = "golden-diff";
+    char cwd[4096];
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            bus_dir = argv[++i];
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+            gold_dir = argv[++i];
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            threads = strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--hex") && i + 1 < argc)
+            hex_dir = argv[++i];
+        else if (!strcmp(argv[i], "--diff") && i + 1 < argc)
+            diff_dir = argv[++i];
+        else if (argv[i][0] != '-' && add_scenario(&job, argv[i]) == 0)
+            ;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+
+    if (!job.n) {
+        DIR *d = opendir(bus_dir);
+        struct dirent *e;
+        if (!d) {
+            perror(bus_dir);
+            return 1;
+        }
+        while ((e = readdir(d))) {
+            size_t len = strlen(e->d_name);
+            if (len > 4 && !strcmp(e->d_name + len - 4, ".bus"))
+                add_scenario(&job, e->d_name);
+        }
+        closedir(d);
+        qsort(job.sc, job.n, sizeof job.sc[0], by_name);
+    }
+    if (mkdir(diff_dir, 0777) < 0 && errno != EEXIST) {
+        perror(diff_dir);
+        return 1;
+    }
+    if (!getcwd(cwd, sizeof cwd) || chdir(hex_dir) < 0) {
+        perror(hex_dir);
+        return 1;
+    }
+    absolute(job.gold_dir, cwd, gold_dir);
+    absolute(job.bus_dir, cwd, bus_dir);
+    absolute(job.diff_dir, cwd, diff_dir);
+
+    pthread_t tid[threads];
+    double t0 = now_s();
+    for (long t = 0; t < threads; t++)
+        pthread_create(&tid[t], NULL, worker, &job);
+    for (long t = 0; t < threads; t++)
+        pthread_join(tid[t], NULL);
+    double dt = now_s() - t0;
+
+    unsigned frames = 0, failed = 0;
+    for (unsigned i = 0; i < job.n; i++) {
+        const struct scenario *sc = job.sc[i];
+        frames += sc->frames;
+        if (sc->error[0]) {
+            printf("%-12s ERROR  %s\n", sc->name, sc->error);
+            failed++;
+        } else if (sc->bad_frames) {
+            printf("%-12s FAIL   %u of %u frames differ (first %d), %llu pixels\n", sc->name,
+                   sc->bad_frames, sc->frames, sc->first_bad, (unsigned long long)sc->bad_pixels);
+            failed++;
+        } else {
+            printf("%-12s ok     %u frames\n", sc->name, sc->frames);
+        }
+    }
+    printf("%u scenarios, %u RTL frames in %.2f s on %ld threads: %u failed\n",
+           job.n, frames, dt, threads, failed);
+    return failed != 0;
+}
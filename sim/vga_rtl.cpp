@@ -0,0 +1,126 @@
+/*  vga_rtl.cpp – clocking, bus writes and frame capture for Vvga_ball */
+
+#include "vga_rtl.h"
+#include "Vvga_ball.h"
+#include "verilated.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+VgaRtl::VgaRtl()
+    : ctx(new VerilatedContext), cycles(0), frames(0), stalled(false), capture(true),
+      hcount(0), vcount(0),
+      fb((uint8_t *)calloc(HACTIVE * VACTIVE, 3))
+{
+    top = new Vvga_ball(ctx);
+    top->clk = 0;
+    top->reset = 0;
+    top->chipselect = 0;
+    top->write = 0;
+    top->address = 0;
+    top->writedata = 0;
+    top->controller_report = 0;
+    top->L_READY = 0;
+    top->R_READY = 0;
+    top->eval();
+}
+
+VgaRtl::~VgaRtl()
+{
+    top->final();
+    delete top;
+    delete ctx;
+    free(fb);
+}
+
+inline void VgaRtl::clock()
+{
+    unsigned h = hcount, v = vcount;
+
+    top->clk = 1;
+    top->eval();
+    top->clk = 0;
+    top->eval();
+    cycles++;
+
+    if (capture && h < HACTIVE && v < VACTIVE) {
+        uint8_t *p = fb + 3 * (v * HACTIVE + h);
+        p[0] = top->VGA_R;
+        p[1] = top->VGA_G;
+        p[2] = top->VGA_B;
+    }
+    if (++hcount == HTOTAL) {
+        hcount = 0;
+        if (++vcount == VTOTAL) {
+            vcount = 0;
+            frames++;
+        }
+    }
+}
+
+void VgaRtl::reset()
+{
+    top->reset = 1;
+    for (int i = 0; i < 4; i++) {
+        top->clk = 1;
+        top->eval();
+        top->clk = 0;
+        top->eval();
+    }
+    top->reset = 0;
+    top->eval();
+    cycles = frames = 0;
+    hcount = vcount = 0;
+}
+
+void VgaRtl::write(unsigned address, uint32_t writedata)
+{
+    top->chipselect = 1;
+    top->write = 1;
+    top->address = address;
+    top->writedata = writedata;
+    clock();
+    idle();
+}
+
+void VgaRtl::stall(bool on)
+{
+    stalled = on;
+    idle();
+}
+
+void VgaRtl::idle()
+{
+    top->chipselect = stalled;
+    top->write = stalled;
+    top->address = STALL_ADDRESS;
+    top->writedata = 0;
+}
+
+void VgaRtl::run(uint64_t n)
+{
+    while (n--)
+        clock();
+}
+
+void VgaRtl::run_frame()
+{
+    do
+        clock();
+    while (hcount || vcount);
+}
+
+int VgaRtl::write_ppm(const char *path, bool wide) const
+{
+    FILE *f = fopen(path, "wb");
+    unsigned step = wide ? 1 : 2;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "P6\n%u %u\n255\n", HACTIVE / step, (unsigned)VACTIVE);
+    for (unsigned v = 0; v < VACTIVE; v++)
+        for (unsigned h = 0; h < HACTIVE; h += step)
+            fwrite(pixel(h, v), 3, 1, f);
+    return fclose(f);
+}
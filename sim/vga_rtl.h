@@ -0,0 +1,72 @@
+#ifndef VGA_RTL_H
+#define VGA_RTL_H
+
+#include <stdint.h>
+
+/* vga_ball.sv under Verilator, clocked one 50 MHz cycle at a time: the
+ * board's (vga_check) or final/staged's (vga_sim, vga_golden).
+ *
+ * The harness keeps its own copy of vga_counters' hcount/vcount (they
+ * only reset with KEY and nothing stalls them) and latches VGA_R/G/B
+ * after every clock, so a whole frame is in fb once run_frame()
+ * returns.  The colour registers lag the counters by one clock; fb is
+ * indexed by the counter values they were computed from.
+ */
+
+class Vvga_ball;
+class VerilatedContext;
+
+class VgaRtl {
+public:
+    enum {
+        HTOTAL  = 1600, VTOTAL = 525,
+        HACTIVE = 1280, VACTIVE = 480,
+        FRAME_CYCLES = HTOTAL * VTOTAL,
+        STALL_ADDRESS = 2,              // no register there
+    };
+
+    /* $readmemh paths in the ROMs are relative, so construct this from
+       the directory holding the .hex files (see the Makefile's hex rule). */
+    VgaRtl();
+    ~VgaRtl();
+
+    /* KEY reset for a few clocks; counters restart at 0,0. */
+    void reset();
+
+    /* One Avalon write cycle, word address.  The game logic stalls for it. */
+    void write(unsigned address, uint32_t writedata);
+
+    /* With on, keeps a write to STALL_ADDRESS on the bus between write()s:
+       the game logic stands still and the video path runs on, so a frame
+       shows whatever state was poked in (--public-flat-rw builds). */
+    void stall(bool on);
+
+    /* n clocks with the bus idle. */
+    void run(uint64_t n);
+
+    /* Runs to the end of the current frame (vcount/hcount back at 0,0). */
+    void run_frame();
+
+    /* One row per vcount, one RGB triple per hcount (HACTIVE wide). */
+    const uint8_t *pixel(unsigned h, unsigned v) const { return fb + 3 * (v * HACTIVE + h); }
+
+    /* P6 image.  wide=false keeps every other column, the 640 a monitor
+       latches on VGA_CLK; wide=true keeps every clock. */
+    int write_ppm(const char *path, bool wide) const;
+
+    Vvga_ball        *top;
+    VerilatedContext *ctx;
+    uint64_t cycles;                    // since reset
+    uint64_t frames;                    // completed since reset
+    bool     stalled;                   // see stall()
+    bool     capture;                   // fill fb (on by default)
+    unsigned hcount, vcount;            // counters at the next clock edge
+
+private:
+    inline void clock();
+    void idle();
+
+    uint8_t *fb;
+};
+
+#endif